@@ -1,9 +1,10 @@
 #include "app_hal.hpp"
 
+#include <algorithm>
+
 #include "app_check.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "ynv_trace.hpp"
 
 namespace app
 {
@@ -29,8 +30,20 @@ esp_err_t HAL::init(ynv::app::AppConfig_t* appConfig, const app::hal::CD74HC4067
     err = m_mux.init(cd74hc4067Config);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to initialize CD74HC4067");
 
-    err = m_dac.init(mcp4725Config);
+    // DAC transfers overlap with the mux setup, which needs an asynchronous bus
+    app::hal::MCP4725::Config_t dacConfig = mcp4725Config;
+    if (dacConfig.busHandle == nullptr && dacConfig.transQueueDepth == 0)
+    {
+        dacConfig.transQueueDepth = DAC_QUEUE_DEPTH;
+    }
+
+    err = m_dac.init(dacConfig);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to initialize MCP4725");
+    m_lastCommon    = -1;
+    m_pendingCommon = -1;
+
+    err = m_engine.init(&HAL::endPulse, this);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to initialize pulse engine");
 
     ESP_LOGI(TAG, "HAL initialized");
 
@@ -38,14 +51,77 @@ esp_err_t HAL::init(ynv::app::AppConfig_t* appConfig, const app::hal::CD74HC4067
 }
 
 esp_err_t HAL::digitalWrite(int pin, bool high, int delay, int common)
+{
+    assert(delay > 0);
+
+    ynv::driver::Pulse_t p = {.pin = pin, .high = high, .durationUs = delay * 1000, .common = common};
+    return runPulse(p);
+}
+
+esp_err_t HAL::pulse(const ynv::driver::Pulse_t* pulses, size_t count)
+{
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < count; ++i)
+    {
+        esp_err_t err = runPulse(pulses[i]);
+        if (ret == ESP_OK)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+esp_err_t HAL::runPulse(const ynv::driver::Pulse_t& p)
 {
     esp_err_t err = ESP_OK;
 
-    ESP_LOGI(TAG, "digitalWrite: pin=%d, high=%s, delay=%d, common=%d", pin, high ? "true" : "false", delay, common);
-    assert(common > 0);
-    assert(delay > 0);
-    assert(pin > 0 && pin < 16);  // CD74HC4067 has 16 channels (0-15), pin-0 won't be used
+    assert(p.common > 0);
+    assert(p.durationUs > 0);
+    assert(p.pin > 0 && p.pin < 16);  // CD74HC4067 has 16 channels (0-15), pin-0 won't be used
+
+    YNV_TRACE_PULSE(p.pin, p.high, p.durationUs, p.common);
+
+    // start setting the reference voltage on the DAC, the mux is set up during the transfer
+    err = startCommon(clampCommon(p.high, p.common));
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to write common");
+
+    // on failure the DAC transfer must still complete, the next startCommon() would queue a second one
+    err = m_mux.select(p.pin);
+    if (err != ESP_OK)
+    {
+        (void)finishCommon();
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to select mux channel");
+    }
+
+    // set the level before connecting the segment, the pulse starts with enable
+    err = m_mux.write(p.high);
+    if (err != ESP_OK)
+    {
+        (void)finishCommon();
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to write to mux");
+    }
+
+    // the segment must not see the previous common voltage
+    err = finishCommon();
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to write common");
+
+    err = m_mux.enable();
+    if (err != ESP_OK)
+    {
+        (void)m_mux.disable();
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to enable mux");
+    }
+
+    // the pulse engine disables the mux when the pulse time is over
+    err = m_engine.hold(p.durationUs);
+    APP_RETURN_ON_ERROR(err, TAG, "Pulse failed");
+
+    return err;
+}
 
+int HAL::clampCommon(bool high, int common) const
+{
     if (high && (m_appConfig->highPinVoltage - common > m_appConfig->maxSegmentVoltage))
     {
         ESP_LOGW(TAG, "common voltage out of range for HIGH pin, adjusting: (%d->%d)", common,
@@ -58,59 +134,89 @@ esp_err_t HAL::digitalWrite(int pin, bool high, int delay, int common)
                  m_appConfig->maxSegmentVoltage);
         common = m_appConfig->maxSegmentVoltage;
     }
+    return common;
+}
 
-    // set the reference voltage on the DAC
-    err = m_dac.write((uint16_t)common);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to write common");
-
-    err = m_mux.select(pin);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to select mux channel");
-
-    err = m_mux.enable();
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to enable mux");
-
-    err = m_mux.write(high);
+void HAL::endPulse(void* arg)
+{
+    (void)static_cast<HAL*>(arg)->m_mux.disable();
+}
 
-    if (err == ESP_OK)
+esp_err_t HAL::startCommon(int common)
+{
+    if (common == m_lastCommon)
     {
-        vTaskDelay(pdMS_TO_TICKS(delay));  // wait for the specified delay
+        return ESP_OK;  // DAC output already set, avoid the I2C transaction
     }
-    else
+
+    // the DAC state is unknown until the transfer has completed
+    m_lastCommon    = -1;
+    esp_err_t err   = m_dac.writeFastAsync((uint16_t)common);
+    m_pendingCommon = (err == ESP_OK) ? common : -1;
+    return err;
+}
+
+esp_err_t HAL::finishCommon()
+{
+    if (m_pendingCommon < 0)
     {
-        ESP_LOGE(TAG, "Failed to write to mux");
+        return ESP_OK;
     }
 
-    (void)m_mux.disable();
-
+    esp_err_t err = m_dac.waitWrite();
+    // on failure the DAC state is unknown, force a write next time
+    m_lastCommon    = (err == ESP_OK) ? m_pendingCommon : -1;
+    m_pendingCommon = -1;
     return err;
 }
 
 int HAL::analogRead(int pin)
 {
-    esp_err_t err = ESP_OK;
-    uint16_t  val = 0;
+    int val = -1;
+    (void)analogReadMany(&pin, 1, &val);
+    return val;
+}
 
-    assert(pin > 0 && pin < 16);  // CD74HC4067 has 16 channels (0-15), pin-0 won't be used
+esp_err_t HAL::analogReadMany(const int* pins, size_t count, int* values)
+{
+    esp_err_t err     = ESP_OK;
+    int       samples = std::clamp(m_appConfig->analogSamples, 1, app::hal::CD74HC4067::MAX_SAMPLES);
 
-    if ((m_mux.select(pin) == ESP_OK) && (m_mux.enable() == ESP_OK))
-    {
-        err = m_mux.read(val);
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(TAG, "Failed to read from mux");
-            return -1;
-        }
+    std::fill(values, values + count, -1);
 
+    // The Signal pin is a high impedance ADC input, so the mux stays enabled while it walks through the
+    // channels: one enable/disable per scan instead of per pin. Stop driving Signal before enabling.
+    err = m_mux.configureRead();
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to configure mux for reading");
+
+    err = m_mux.enable();
+    if (err != ESP_OK)
+    {
         (void)m_mux.disable();
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to enable mux");
     }
-    else
+
+    for (size_t i = 0; i < count && err == ESP_OK; ++i)
     {
-        ESP_LOGE(TAG, "Failed to configure mux");
-        return -1;
+        assert(pins[i] > 0 && pins[i] < 16);  // CD74HC4067 has 16 channels (0-15), pin-0 won't be used
+
+        uint16_t val = 0;
+        err          = m_mux.select(pins[i]);
+        if (err == ESP_OK)
+        {
+            err = m_mux.read(val, samples);
+        }
+        if (err == ESP_OK)
+        {
+            values[i] = val;
+            YNV_TRACE_ADC_READ(pins[i], val);
+        }
     }
-    ESP_LOGI(TAG, "analogRead: pin=%d val=%d", pin, val);
 
-    return val;
+    (void)m_mux.disable();
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to read from mux");
+
+    return err;
 }
 
 }  // namespace hal
@@ -4,6 +4,7 @@
 #include "cd74hc4067.hpp"
 #include "esp_err.h"
 #include "mcp4725.hpp"
+#include "pulse_engine.hpp"
 #include "ynv_hal.hpp"
 
 namespace app
@@ -32,14 +33,28 @@ class HAL : public ynv::driver::HALBase
                    const app::hal::MCP4725::Config_t& mcp4725Config);  // Initialize the HAL
 
     esp_err_t digitalWrite(int pin, bool high, int delay = 10, int common = 0) override;
+    esp_err_t pulse(const ynv::driver::Pulse_t* pulses, size_t count) override;
     int       analogRead(int pin) override;
+    esp_err_t analogReadMany(const int* pins, size_t count, int* values) override;
 
    private:
     // Private constructor
-    HAL() : m_mux(), m_dac() { }
+    HAL() : m_mux(), m_dac(), m_engine(), m_lastCommon(-1), m_pendingCommon(-1) { }
 
-    app::hal::CD74HC4067 m_mux;  // CD74HC4067 multiplexer instance
-    app::hal::MCP4725    m_dac;  // MCP4725 DAC instance
+    static constexpr size_t DAC_QUEUE_DEPTH = 2;  // I2C transaction queue for asynchronous DAC writes
+
+    esp_err_t startCommon(int common);                   // Start writing the common voltage, skipped if unchanged
+    esp_err_t finishCommon();                            // Wait for the common voltage started by startCommon
+    int       clampCommon(bool high, int common) const;  // Limit the common voltage to the safe segment voltage
+    esp_err_t runPulse(const ynv::driver::Pulse_t& p);   // Run a single pulse on the pulse engine
+
+    static void endPulse(void* arg);  // Pulse engine callback, disables the mux
+
+    app::hal::CD74HC4067  m_mux;            // CD74HC4067 multiplexer instance
+    app::hal::MCP4725     m_dac;            // MCP4725 DAC instance
+    app::hal::PulseEngine m_engine;         // Pulse timing
+    int                   m_lastCommon;     // Last DAC code written, -1 if unknown
+    int                   m_pendingCommon;  // DAC code being written, -1 if none
 
     // Private members for the application-specific HAL implementation
 };
@@ -1,17 +1,31 @@
 
 #include "cd74hc4067.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 
 #include "app_check.h"
 #include "driver/gpio.h"
+#include "driver/rtc_io.h"
 #include "esp_adc/adc_oneshot.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
 
 namespace app
 {
 namespace hal
 {
 
+CD74HC4067::~CD74HC4067()
+{
+    if (m_adcHandle != nullptr)
+    {
+        (void)adc_oneshot_del_unit(m_adcHandle);
+    }
+}
+
 esp_err_t CD74HC4067::init(const Config_t& config)
 {
     esp_err_t err = ESP_OK;
@@ -39,36 +53,71 @@ esp_err_t CD74HC4067::init(const Config_t& config)
     err                 = gpio_config(&ioConf);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to configure Select pins");
 
+    m_selectLut  = selectLut(m_config);
+    m_selectMask = m_selectLut[CHANNEL_COUNT - 1];
+    m_channel    = -1;
+
     // Signal can be analog input or digital output.
-    // read and write will configure the Signal pin when using it
+    // Configure it as GPIO output first so that the IO_MUX function is GPIO when the pad leaves the analog domain.
+    ioConf              = {};
+    ioConf.pin_bit_mask = (1ull << (int)m_config.signal);
+    ioConf.intr_type    = GPIO_INTR_DISABLE;
+    ioConf.mode         = GPIO_MODE_OUTPUT;
+    ioConf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    ioConf.pull_up_en   = GPIO_PULLUP_ENABLE;
+    err                 = gpio_config(&ioConf);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to configure Signal pin");
+
+    // The ADC unit is created once here and kept until destruction. read and write only switch the pad routing.
     err = adc_oneshot_io_to_channel(m_config.signal, &m_adcUnit, &m_adcChannel);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to configure Signal pin");
 
+    adc_oneshot_unit_init_cfg_t unitConfig = {
+        .unit_id = m_adcUnit,
+    };
+    err = adc_oneshot_new_unit(&unitConfig, &m_adcHandle);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to create ADC unit");
+
+    m_adcChanConfig = {
+        .atten    = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+
     m_initialised = true;
 
+    // leave the pad in the analog domain (high-z) until the first write
+    err = configureRead();
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to configure Signal pin for reading");
+
     return err;
 }
 
 esp_err_t CD74HC4067::select(uint8_t channel)
 {
     assert(m_initialised);
-    assert(channel < 16);
-
-    esp_err_t err = ESP_OK;
+    assert(channel < CHANNEL_COUNT);
 
-    err = gpio_set_level(m_config.s0, (channel >> 0) & 0x01);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to set S0 pin");
-
-    err = gpio_set_level(m_config.s1, (channel >> 1) & 0x01);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to set S1 pin");
+    if (channel == m_channel)
+    {
+        return ESP_OK;
+    }
 
-    err = gpio_set_level(m_config.s2, (channel >> 2) & 0x01);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to set S2 pin");
+    // Clear, then set: the lines pass through the channel of the bits common to both, select with the mux disabled
+    uint64_t set   = m_selectLut[channel];
+    uint64_t clear = m_selectMask & ~set;
 
-    err = gpio_set_level(m_config.s3, (channel >> 3) & 0x01);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to set S3 pin");
+    REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)clear);
+    REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)set);
+#if SOC_GPIO_PIN_COUNT > 32
+    if ((m_selectMask >> 32) != 0)
+    {
+        REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(clear >> 32));
+        REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(set >> 32));
+    }
+#endif
 
-    return err;
+    m_channel = channel;
+    return ESP_OK;
 }
 
 esp_err_t CD74HC4067::enable()
@@ -101,83 +150,71 @@ esp_err_t CD74HC4067::configureRead()
         // already configured for input
         return ESP_OK;
     }
-    else if (m_signalIO == SignalIO_t::OUTPUT)
-    {
-        // release output resources
-        err = releaseWrite();
-        APP_RETURN_ON_ERROR(err, TAG, "Failed to release GPIO resources");
-    }
 
-    adc_oneshot_unit_init_cfg_t init_config1 = {
-        .unit_id = m_adcUnit,
-    };
-    err = adc_oneshot_new_unit(&init_config1, &m_adcHandle);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to create ADC unit");
+    // stop driving the pad before handing it to the ADC
+    err = gpio_set_direction(m_config.signal, GPIO_MODE_DISABLE);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to disable Signal pin");
 
-    m_signalIO = SignalIO_t::INPUT;
+    err = gpio_set_pull_mode(m_config.signal, GPIO_FLOATING);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to set pull mode for Signal pin");
 
-    //-------------ADC1 Config_t---------------//
-    adc_oneshot_chan_cfg_t config = {
-        .atten    = ADC_ATTEN_DB_12,
-        .bitwidth = ADC_BITWIDTH_12,
-    };
-    err = adc_oneshot_config_channel(m_adcHandle, m_adcChannel, &config);
+    // Re-applying the channel config routes the pad back to the analog domain.
+    // It only touches IO/ADC registers, the unit itself stays allocated.
+    err = adc_oneshot_config_channel(m_adcHandle, m_adcChannel, &m_adcChanConfig);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to configure ADC channel");
 
+    m_signalIO = SignalIO_t::INPUT;
+
     return ESP_OK;
 }
 
-esp_err_t CD74HC4067::read(uint16_t& value)
+esp_err_t CD74HC4067::read(uint16_t& value, int samples)
 {
     assert(m_initialised);
+    assert(samples > 0 && samples <= MAX_SAMPLES);
 
-    int       val = 0;
-    esp_err_t err = ESP_OK;
+    std::array<int, MAX_SAMPLES> vals {};
+    esp_err_t                    err = ESP_OK;
 
     APP_RETURN_ON_ERROR(configureRead(), TAG, "Failed to configure for reading");
 
-    err = adc_oneshot_read(m_adcHandle, m_adcChannel, &val);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to read ADC channel");
-
-    value = (uint16_t)val;
-    return ESP_OK;
-}
-
-esp_err_t CD74HC4067::releaseRead()
-{
-    assert(m_initialised);
+    for (int i = 0; i < samples; ++i)
+    {
+        err = adc_oneshot_read(m_adcHandle, m_adcChannel, &vals[i]);
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to read ADC channel");
+    }
 
-    esp_err_t err = adc_oneshot_del_unit(m_adcHandle);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to release ADC unit");
-    m_adcHandle = nullptr;
+    // the median rejects single outliers (e.g. switching spikes) that an average would smear in
+    std::nth_element(vals.begin(), vals.begin() + samples / 2, vals.begin() + samples);
 
+    value = (uint16_t)vals[samples / 2];
     return ESP_OK;
 }
 
 esp_err_t CD74HC4067::configureWrite()
 {
     assert(m_initialised);
+    esp_err_t err = ESP_OK;
 
     if (m_signalIO == SignalIO_t::OUTPUT)
     {
         // already configured for output
         return ESP_OK;
     }
-    else if (m_signalIO == SignalIO_t::INPUT)
+
+#if SOC_RTCIO_INPUT_OUTPUT_SUPPORTED
+    // ADC channel config hands RTC-capable pads to the RTC domain, take it back to the digital GPIO matrix
+    if (rtc_gpio_is_valid_gpio(m_config.signal))
     {
-        // release input resources
-        esp_err_t err = releaseRead();
-        APP_RETURN_ON_ERROR(err, TAG, "Failed to release ADC resources");
+        err = rtc_gpio_deinit(m_config.signal);
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to release Signal pin from RTC domain");
     }
+#endif
 
-    gpio_config_t ioConf = {};
-    ioConf.pin_bit_mask  = (1ull << (int)m_config.signal);
-    ioConf.intr_type     = GPIO_INTR_DISABLE;
-    ioConf.mode          = GPIO_MODE_OUTPUT;
-    ioConf.pull_down_en  = GPIO_PULLDOWN_DISABLE;
-    ioConf.pull_up_en    = GPIO_PULLUP_ENABLE;
+    err = gpio_set_pull_mode(m_config.signal, GPIO_PULLUP_ONLY);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to set pull mode for Signal pin");
 
-    esp_err_t err = gpio_config(&ioConf);
+    err = gpio_set_direction(m_config.signal, GPIO_MODE_OUTPUT);
     APP_RETURN_ON_ERROR(err, TAG, "Failed to configure Signal pin for writing");
 
     m_signalIO = SignalIO_t::OUTPUT;
@@ -198,23 +235,5 @@ esp_err_t CD74HC4067::write(bool high)
     return err;
 }
 
-esp_err_t CD74HC4067::releaseWrite()
-{
-    assert(m_initialised);
-
-    esp_err_t err = ESP_OK;
-
-    err = gpio_reset_pin(m_config.signal);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to reset Signal pin");
-
-    err = gpio_set_pull_mode(m_config.signal, GPIO_FLOATING);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to set pull mode for Signal pin");
-
-    err = gpio_set_direction(m_config.signal, GPIO_MODE_DISABLE);
-    APP_RETURN_ON_ERROR(err, TAG, "Failed to disable Signal pin");
-
-    return ESP_OK;
-}
-
 }  // namespace hal
 }  // namespace app
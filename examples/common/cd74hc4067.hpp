@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <array>
+#include <cinttypes>
+
 #include "driver/gpio.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_err.h"
@@ -24,15 +27,37 @@ class CD74HC4067
         gpio_num_t enable;
     };
 
-    CD74HC4067() : m_initialised(false), m_adcHandle(nullptr) { }
+    static constexpr int CHANNEL_COUNT = 16;
+    static constexpr int MAX_SAMPLES   = 16;  // oversampling limit of read()
+
+    // Output register bits of S0..S3 to set per channel (GPIO0-31 in the low word, GPIO32+ in the high word)
+    typedef std::array<uint64_t, CHANNEL_COUNT> SelectLut_t;
+
+    // Build the select lookup table, usable at compile time for a constexpr Config_t
+    static constexpr SelectLut_t selectLut(const Config_t& config)
+    {
+        SelectLut_t lut {};
+        for (int channel = 0; channel < CHANNEL_COUNT; ++channel)
+        {
+            lut[channel] = (((channel >> 0) & 1) ? (1ull << (int)config.s0) : 0) |
+                           (((channel >> 1) & 1) ? (1ull << (int)config.s1) : 0) |
+                           (((channel >> 2) & 1) ? (1ull << (int)config.s2) : 0) |
+                           (((channel >> 3) & 1) ? (1ull << (int)config.s3) : 0);
+        }
+        return lut;
+    }
+
+    CD74HC4067() : m_initialised(false), m_selectLut(), m_selectMask(0), m_channel(-1), m_adcHandle(nullptr) { }
+    ~CD74HC4067();
 
     esp_err_t init(const Config_t& config);  // Configure pins
-    esp_err_t select(uint8_t channel);       // select a channel by using Select pins
+    esp_err_t select(uint8_t channel);       // select a channel by using Select pins, no-op if already selected
     esp_err_t enable();                      // enable a channel by taking Enable low
     esp_err_t disable();                     // high-z, default
 
-    esp_err_t read(uint16_t& value);  // analog read
-    esp_err_t write(bool high);       // digital write
+    esp_err_t read(uint16_t& value, int samples = 1);  // analog read, median of samples
+    esp_err_t configureRead();                         // route Signal pad to ADC, done by read() if needed
+    esp_err_t write(bool high);                        // digital write
 
     static constexpr const char* TAG = "CD74HC4067";
 
@@ -48,14 +73,19 @@ class CD74HC4067
     bool       m_initialised;
     SignalIO_t m_signalIO = SignalIO_t::NONE;
 
+    // Select lines are written through the GPIO output set/clear registers, all four bits at once
+    SelectLut_t m_selectLut;   // bits to set per channel
+    uint64_t    m_selectMask;  // bits of S0..S3
+    int         m_channel;     // selected channel, -1 if unknown
+
+    // ADC unit and channel are created once in init() and kept for the lifetime of the driver.
+    // Switching the Signal pin between read and write only changes the pad routing.
     adc_oneshot_unit_handle_t m_adcHandle;
     adc_unit_t                m_adcUnit;
     adc_channel_t             m_adcChannel;
+    adc_oneshot_chan_cfg_t    m_adcChanConfig;
 
-    esp_err_t configureRead();   // prep analog read
-    esp_err_t configureWrite();  // prep digital write
-    esp_err_t releaseRead();     // release resources
-    esp_err_t releaseWrite();    // release resources
+    esp_err_t configureWrite();  // route Signal pad to GPIO output
 };
 
 }  // namespace hal
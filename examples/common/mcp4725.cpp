@@ -13,10 +13,15 @@ namespace hal
 
 MCP4725::~MCP4725()
 {
+    if (m_devHandle != nullptr)
+    {
+        // the bus can only be deleted without devices
+        (void)i2c_master_bus_rm_device(m_devHandle);
+    }
     if (m_initialized && m_config.busHandle == nullptr)
     {
         // Deinitialize the I2C bus
-        i2c_del_master_bus(m_i2cBusHandle);
+        (void)i2c_del_master_bus(m_i2cBusHandle);
     }
 }
 
@@ -31,6 +36,30 @@ esp_err_t MCP4725::init(const Config_t& config)
 
     m_config = config;
 
+    if (m_config.busMode >= BUS_MODE_CNT)
+    {
+        ESP_LOGE(TAG, "Invalid bus mode %d", (int)m_config.busMode);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (m_config.busMode == BUS_MODE_HIGH_SPEED)
+    {
+        // HS mode starts with the master code (0b00001xxx) at <= 400 kHz, then switches to 3.4 MHz after a repeated
+        // START. The i2c_master driver runs a device at one fixed SCL speed and cannot switch within a transaction.
+        ESP_LOGE(TAG, "High-Speed mode is not supported by the I2C master driver");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    uint32_t maxFreqHz = BUS_MODE_MAX_FREQ_HZ[m_config.busMode];
+    if (m_config.i2cFreqHz == 0)
+    {
+        m_config.i2cFreqHz = maxFreqHz;
+    }
+    if (m_config.i2cFreqHz > maxFreqHz)
+    {
+        ESP_LOGE(TAG, "%" PRIu32 " Hz exceeds the bus mode limit of %" PRIu32 " Hz", m_config.i2cFreqHz, maxFreqHz);
+        return ESP_ERR_INVALID_ARG;
+    }
+
     if (m_config.busHandle != nullptr)
     {
         m_i2cBusHandle = m_config.busHandle;
@@ -44,6 +73,7 @@ esp_err_t MCP4725::init(const Config_t& config)
             .scl_io_num        = m_config.i2cSclGpio,
             .clk_source        = I2C_CLK_SRC_DEFAULT,
             .glitch_ignore_cnt = 7,
+            .trans_queue_depth = m_config.transQueueDepth,
         };
 
         err = i2c_new_master_bus(&masterCfg, &m_i2cBusHandle);
@@ -57,9 +87,24 @@ esp_err_t MCP4725::init(const Config_t& config)
     };
 
     err = i2c_master_bus_add_device(m_i2cBusHandle, &devCfg, &m_devHandle);
+    if (err != ESP_OK && m_config.busHandle == nullptr)
+    {
+        (void)i2c_del_master_bus(m_i2cBusHandle);  // do not leak the bus created above
+        m_i2cBusHandle = nullptr;
+    }
     APP_RETURN_ON_ERROR(err, TAG, "Failed to add I2C device");
 
+    if (m_config.transQueueDepth > 0)
+    {
+        const i2c_master_event_callbacks_t cbs = {
+            .on_trans_done = &MCP4725::onTransDone,
+        };
+        err = i2c_master_register_event_callbacks(m_devHandle, &cbs, this);
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to register I2C callbacks");
+    }
+
     // Initialize the I2C bus and the MCP4725
+    ESP_LOGI(TAG, "I2C at %" PRIu32 " Hz", m_config.i2cFreqHz);
     m_initialized = true;
     return err;
 }
@@ -72,9 +117,107 @@ esp_err_t MCP4725::write(uint16_t value)
     // see the datasheet, p25: Write DAC Register: (C2, C1, C0)=0,1,0,0 -> first byte is 0x40
     uint8_t data[] = {(0x40), (uint8_t)(value >> 4), (uint8_t)(value << 4)};
 
-    ESP_ERROR_CHECK(i2c_master_transmit(m_devHandle, data, sizeof(data), -1));
+    ESP_ERROR_CHECK(transmit(data, sizeof(data)));
+    return ESP_OK;
+}
+
+esp_err_t MCP4725::writeFast(uint16_t value)
+{
+    return writeSequence(&value, 1);
+}
+
+esp_err_t MCP4725::writeSequence(const uint16_t* values, size_t count)
+{
+    assert(m_initialized);
+    assert(values != nullptr);
+
+    while (count > 0)
+    {
+        size_t chunk = (count < MAX_SEQUENCE_LENGTH) ? count : MAX_SEQUENCE_LENGTH;
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            assert(values[i] < (1 << 12));  // 12-bit DAC
+
+            // see the datasheet, p24: Fast Mode: (C2, C1, PD1, PD0)=0,0,0,0 + D11..D8, then D7..D0
+            m_buffer[2 * i]     = (uint8_t)((values[i] >> 8) & 0x0F);
+            m_buffer[2 * i + 1] = (uint8_t)(values[i] & 0xFF);
+        }
+
+        esp_err_t err = transmit(m_buffer.data(), 2 * chunk);
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to write DAC");
+
+        values += chunk;
+        count  -= chunk;
+    }
+    return ESP_OK;
+}
+
+esp_err_t MCP4725::writeFastAsync(uint16_t value)
+{
+    assert(m_initialized);
+    assert(value < (1 << 12));  // 12-bit DAC
+
+    // the frame buffer is reused, finish the previous transfer first
+    esp_err_t err = waitWrite();
+    APP_RETURN_ON_ERROR(err, TAG, "Previous DAC write failed");
+
+    m_asyncFrame[0] = (uint8_t)((value >> 8) & 0x0F);
+    m_asyncFrame[1] = (uint8_t)(value & 0xFF);
+    m_asyncResult   = ESP_OK;
+
+    // returns right away on an asynchronous bus, the callback reports the result
+    err = i2c_master_transmit(m_devHandle, m_asyncFrame.data(), m_asyncFrame.size(), -1);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to start DAC write");
+    m_asyncPending = (m_config.transQueueDepth > 0);
     return ESP_OK;
 }
 
+esp_err_t MCP4725::waitWrite(int timeoutMs)
+{
+    if (!m_asyncPending)
+    {
+        return ESP_OK;
+    }
+
+    esp_err_t err = i2c_master_bus_wait_all_done(m_i2cBusHandle, timeoutMs);
+    APP_RETURN_ON_ERROR(err, TAG, "DAC write did not complete");
+    m_asyncPending = false;
+    return m_asyncResult;
+}
+
+esp_err_t MCP4725::transmit(const uint8_t* data, size_t size)
+{
+    esp_err_t err = waitWrite();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = i2c_master_transmit(m_devHandle, data, size, -1);
+    if (err == ESP_OK && m_config.transQueueDepth > 0)
+    {
+        // data may live on the caller's stack, wait until it is sent
+        m_asyncResult  = ESP_OK;
+        m_asyncPending = true;
+        err            = waitWrite();
+    }
+    return err;
+}
+
+bool MCP4725::onTransDone(i2c_master_dev_handle_t dev, const i2c_master_event_data_t* evt, void* arg)
+{
+    (void)dev;
+    auto* self = static_cast<MCP4725*>(arg);
+    if (evt->event == I2C_EVENT_NACK)
+    {
+        self->m_asyncResult = ESP_ERR_INVALID_RESPONSE;
+    }
+    else if (evt->event == I2C_EVENT_TIMEOUT)
+    {
+        self->m_asyncResult = ESP_ERR_TIMEOUT;
+    }
+    return false;  // no task woken
+}
+
 }  // namespace hal
 }  // namespace app
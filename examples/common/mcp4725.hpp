@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <cinttypes>
+#include <cstddef>
 
 #include "driver/gpio.h"
 #include "driver/i2c_master.h"
@@ -14,30 +16,76 @@ namespace hal
 class MCP4725
 {
    public:
+    // I2C bus modes supported by the MCP4725 (datasheet, p4: SCL clock frequency)
+    enum BusMode_t
+    {
+        BUS_MODE_STANDARD = 0,  // up to 100 kHz
+        BUS_MODE_FAST,          // up to 400 kHz
+        BUS_MODE_HIGH_SPEED,    // up to 3.4 MHz, entered with the HS master code
+        BUS_MODE_CNT
+    };
+
     struct Config_t
     {
-        i2c_master_bus_handle_t busHandle;   // if nullptr, it will be initialised
-        uint8_t                 i2cPort;     // I2C port number
-        uint8_t                 i2cAddr;     // I2C address of the MCP4725
-        gpio_num_t              i2cSdaGpio;  // GPIO number for I2C SDA
-        gpio_num_t              i2cSclGpio;  // GPIO number for I2C SCL
-        uint32_t                i2cFreqHz;   // I2C frequency in Hz
+        i2c_master_bus_handle_t busHandle;        // if nullptr, it will be initialised
+        uint8_t                 i2cPort;          // I2C port number
+        uint8_t                 i2cAddr;          // I2C address of the MCP4725
+        gpio_num_t              i2cSdaGpio;       // GPIO number for I2C SDA
+        gpio_num_t              i2cSclGpio;       // GPIO number for I2C SCL
+        uint32_t                i2cFreqHz;        // I2C frequency in Hz, 0 selects the maximum of busMode
+        BusMode_t               busMode;          // I2C bus mode, limits i2cFreqHz
+        size_t                  transQueueDepth;  // > 0 makes the bus asynchronous (own bus, or busHandle created so)
     };
 
-    MCP4725() : m_config(), m_initialized(false), m_i2cBusHandle(nullptr), m_devHandle(nullptr) { }
+    // maximum SCL frequency per bus mode, indexed by BusMode_t
+    static constexpr std::array<uint32_t, BUS_MODE_CNT> BUS_MODE_MAX_FREQ_HZ = {100000, 400000, 3400000};
+
+    MCP4725()
+        : m_config(),
+          m_initialized(false),
+          m_i2cBusHandle(nullptr),
+          m_devHandle(nullptr),
+          m_buffer(),
+          m_asyncFrame(),
+          m_asyncPending(false),
+          m_asyncResult(ESP_OK)
+    {
+    }
     ~MCP4725();
 
     esp_err_t init(const Config_t& config);
 
     esp_err_t write(uint16_t value);
 
-    static constexpr const char* TAG = "MCP4725";
+    // Fast Mode write (2 bytes instead of 3), DAC register only, power-down bits cleared
+    esp_err_t writeFast(uint16_t value);
+
+    // Stream values as back-to-back Fast Mode writes, each value is output when its last byte is acknowledged.
+    // Up to MAX_SEQUENCE_LENGTH values go out in one I2C transaction, longer sequences are split.
+    esp_err_t writeSequence(const uint16_t* values, size_t count);
+
+    // Start a Fast Mode write and return while it is transferred (blocking if transQueueDepth is 0).
+    // Call waitWrite() before relying on the new output, a pending write is waited for by every write call.
+    esp_err_t writeFastAsync(uint16_t value);
+
+    // Wait for the write started by writeFastAsync(), returns the transfer result
+    esp_err_t waitWrite(int timeoutMs = -1);
+
+    static constexpr size_t      MAX_SEQUENCE_LENGTH = 32;
+    static constexpr const char* TAG                 = "MCP4725";
 
    private:
-    Config_t                m_config;
-    bool                    m_initialized;
-    i2c_master_bus_handle_t m_i2cBusHandle;
-    i2c_master_dev_handle_t m_devHandle;
+    Config_t                                     m_config;
+    bool                                         m_initialized;
+    i2c_master_bus_handle_t                      m_i2cBusHandle;
+    i2c_master_dev_handle_t                      m_devHandle;
+    std::array<uint8_t, 2 * MAX_SEQUENCE_LENGTH> m_buffer;        // Fast Mode frames of writeSequence
+    std::array<uint8_t, 2>                       m_asyncFrame;    // Fast Mode frame of writeFastAsync
+    bool                                         m_asyncPending;  // writeFastAsync transfer not waited for
+    volatile esp_err_t                           m_asyncResult;   // set by the transfer done callback
+
+    esp_err_t   transmit(const uint8_t* data, size_t size);  // blocking transmit, also on an asynchronous bus
+    static bool onTransDone(i2c_master_dev_handle_t dev, const i2c_master_event_data_t* evt, void* arg);
 };
 
 }  // namespace hal
@@ -0,0 +1,109 @@
+/**
+ * @file pulse_engine.cpp
+ * @brief esp_timer based pulse timing with microsecond precision
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "pulse_engine.hpp"
+
+#include <cassert>
+
+#include "app_check.h"
+
+namespace app
+{
+namespace hal
+{
+
+// margin on top of the pulse width before hold() gives up on the timer
+static constexpr int64_t TIMEOUT_MARGIN_US = 100000;
+
+PulseEngine::~PulseEngine()
+{
+    if (m_timer != nullptr)
+    {
+        (void)esp_timer_stop(m_timer);
+        (void)esp_timer_delete(m_timer);
+    }
+    if (m_done != nullptr)
+    {
+        vSemaphoreDelete(m_done);
+    }
+}
+
+esp_err_t PulseEngine::init(PulseEnd_f onEnd, void* arg)
+{
+    assert(onEnd != nullptr);
+    assert(m_timer == nullptr);
+
+    m_onEnd = onEnd;
+    m_arg   = arg;
+
+    m_done = xSemaphoreCreateBinary();
+    if (m_done == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to create semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_timer_create_args_t timerArgs = {
+        .callback              = &PulseEngine::timerCallback,
+        .arg                   = this,
+        .dispatch_method       = ESP_TIMER_TASK,
+        .name                  = "pulse",
+        .skip_unhandled_events = false,
+    };
+    esp_err_t err = esp_timer_create(&timerArgs, &m_timer);
+    APP_RETURN_ON_ERROR(err, TAG, "Failed to create pulse timer");
+
+    return ESP_OK;
+}
+
+esp_err_t PulseEngine::hold(int64_t durationUs)
+{
+    assert(m_timer != nullptr);
+    assert(durationUs > 0);
+
+    m_armed.store(true);
+    esp_err_t err = esp_timer_start_once(m_timer, (uint64_t)durationUs);
+    if (err != ESP_OK)
+    {
+        m_armed.store(false);
+        m_onEnd(m_arg);  // never leave the pulse running
+        APP_RETURN_ON_ERROR(err, TAG, "Failed to start pulse timer");
+    }
+
+    TickType_t timeout = pdMS_TO_TICKS((durationUs + TIMEOUT_MARGIN_US) / 1000) + 1;
+    if (xSemaphoreTake(m_done, timeout) != pdTRUE)
+    {
+        (void)esp_timer_stop(m_timer);  // does not stop a callback already running on the esp_timer task
+        if (m_armed.exchange(false))
+        {
+            m_onEnd(m_arg);  // the callback will not end or signal this pulse any more
+        }
+        else
+        {
+            // the callback claimed the pulse, take its completion so that the next hold() waits for its own
+            (void)xSemaphoreTake(m_done, portMAX_DELAY);
+        }
+        ESP_LOGE(TAG, "Pulse timer did not fire in time");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+void PulseEngine::timerCallback(void* arg)
+{
+    auto* self = static_cast<PulseEngine*>(arg);
+    if (!self->m_armed.exchange(false))
+    {
+        return;  // hold() timed out and ended the pulse
+    }
+    self->m_onEnd(self->m_arg);
+    xSemaphoreGive(self->m_done);
+}
+
+}  // namespace hal
+}  // namespace app
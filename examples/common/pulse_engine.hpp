@@ -0,0 +1,66 @@
+/**
+ * @file pulse_engine.hpp
+ * @brief esp_timer based pulse timing with microsecond precision
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ *
+ * The caller starts a pulse (select, write, enable) and calls hold(). The end of the pulse is
+ * scheduled on a one-shot esp_timer, whose callback ends the pulse and wakes the caller.
+ * The pulse width is therefore not quantized to the FreeRTOS tick and does not depend on when
+ * the caller is scheduled again, and the CPU is free while the pulse runs.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace app
+{
+namespace hal
+{
+
+class PulseEngine
+{
+   public:
+    /** @brief Pulse end callback type, called from the esp_timer task */
+    typedef void (*PulseEnd_f)(void* arg);
+
+    PulseEngine() : m_timer(nullptr), m_done(nullptr), m_onEnd(nullptr), m_arg(nullptr), m_armed(false) { }
+    ~PulseEngine();
+
+    /**
+     * @brief Create the timer and the completion semaphore
+     * @param onEnd Ends the pulse (e.g. disables the multiplexer)
+     * @param arg Argument for onEnd
+     */
+    esp_err_t init(PulseEnd_f onEnd, void* arg);
+
+    /**
+     * @brief Hold the running pulse for the given time and end it
+     * @param durationUs Pulse width (microseconds)
+     * @return ESP_OK on success, ESP_ERR_TIMEOUT if the timer did not fire
+     *
+     * Blocks the calling task without using the CPU until the pulse has ended.
+     */
+    esp_err_t hold(int64_t durationUs);
+
+    static constexpr const char* TAG = "PulseEngine";
+
+   private:
+    esp_timer_handle_t m_timer;  // one-shot pulse end timer
+    SemaphoreHandle_t  m_done;   // given by the timer callback
+    PulseEnd_f         m_onEnd;  // ends the pulse
+    void*              m_arg;    // argument for m_onEnd
+    std::atomic<bool>  m_armed;  // a pulse runs and nobody has claimed its end yet
+
+    static void timerCallback(void* arg);
+};
+
+}  // namespace hal
+}  // namespace app
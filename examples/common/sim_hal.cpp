@@ -0,0 +1,272 @@
+/**
+ * @file sim_hal.cpp
+ * @brief Simulated HAL with an electrochemical segment model for off-target testing and benchmarking
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "sim_hal.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+#include "esp_log.h"
+
+namespace app
+{
+namespace hal
+{
+
+// open-circuit voltage of a fully bleached / fully colored segment, relative to the analog range
+static constexpr float BLEACHED_OCV = 0.15f;
+static constexpr float COLORED_OCV  = 0.95f;
+
+// charge state an open segment relaxes to
+static constexpr float REST_CHARGE = 0.5f;
+
+// oversampling limit, same as CD74HC4067
+static constexpr int MAX_SAMPLES = 16;
+
+esp_err_t SimHAL::init(ynv::app::AppConfig_t* appConfig, const Config_t& config)
+{
+    assert(appConfig != nullptr);
+    m_appConfig = appConfig;
+    // Set the HAL pointer in the application configuration
+    m_appConfig->hal = this;
+    // Same voltage setup as the hardware HAL
+    m_appConfig->highPinVoltage    = (1 << m_appConfig->analogResolution) - 1;
+    m_appConfig->maxSegmentVoltage = m_appConfig->highPinVoltage * ynv::app::AppConfig_t::MAX_SEGMENT_VOLTAGE /
+                                     ynv::app::AppConfig_t::HIGH_PIN_VOLTAGE;
+
+    m_config     = config;
+    m_nowUs      = 0;
+    m_rng        = config.seed != 0 ? config.seed : 1;
+    m_lastCommon = -1;
+    resetStats();
+
+    for (auto& cell : m_cells)
+    {
+        // spread the time constants so that segments do not behave identically
+        int   offset   = (int)(random() % (2 * m_config.tauSpreadPct + 1)) - m_config.tauSpreadPct;
+        float spread   = 1.0f + (float)offset / 100;
+        cell.charge    = 0.0f;
+        cell.chargeTau = m_config.chargeTauMs * spread;
+        cell.relaxTau  = m_config.relaxTauMs * spread;
+        cell.lastUs    = 0;
+    }
+
+    ESP_LOGI(TAG, "SimHAL initialized");
+    return ESP_OK;
+}
+
+esp_err_t SimHAL::digitalWrite(int pin, bool high, int delay, int common)
+{
+    assert(delay > 0);
+
+    ESP_LOGD(TAG, "digitalWrite: pin=%d, high=%s, delay=%d, common=%d", pin, high ? "true" : "false", delay, common);
+
+    drivePulse(pin, high, (int64_t)delay * 1000, common);
+    return ESP_OK;
+}
+
+esp_err_t SimHAL::pulse(const ynv::driver::Pulse_t* pulses, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(pulses[i].durationUs > 0);
+        drivePulse(pulses[i].pin, pulses[i].high, pulses[i].durationUs, pulses[i].common);
+    }
+    return ESP_OK;
+}
+
+void SimHAL::drivePulse(int pin, bool high, int64_t durationUs, int common)
+{
+    assert(common > 0);
+    assert(pin > 0 && pin < CHANNEL_COUNT);
+
+    // same limits as the hardware HAL
+    if (high && (m_appConfig->highPinVoltage - common > m_appConfig->maxSegmentVoltage))
+    {
+        common = m_appConfig->highPinVoltage - m_appConfig->maxSegmentVoltage;
+    }
+    if (!high && common > m_appConfig->maxSegmentVoltage)
+    {
+        common = m_appConfig->maxSegmentVoltage;
+    }
+
+    m_stats.digitalWrites++;
+    int64_t start = m_nowUs;
+    int64_t dacUs = 0;
+    if (common != m_lastCommon)
+    {
+        m_stats.dacWrites++;
+        dacUs        = m_config.dacWriteUs;
+        m_lastCommon = common;
+        trace(m_nowUs, "dac write start", common);
+    }
+
+    if (m_config.asyncDac)
+    {
+        // the mux is set up while the DAC transfer runs, the pulse starts when both are done
+        trace(m_nowUs, "mux select", pin);
+        if (dacUs > 0)
+        {
+            trace(m_nowUs + dacUs, "dac write done", common);
+        }
+        m_nowUs += std::max<int64_t>(dacUs, m_config.muxSwitchUs);
+    }
+    else
+    {
+        if (dacUs > 0)
+        {
+            trace(m_nowUs + dacUs, "dac write done", common);
+        }
+        m_nowUs += dacUs;
+        trace(m_nowUs, "mux select", pin);
+        m_nowUs += m_config.muxSwitchUs;
+    }
+    trace(m_nowUs, "pulse start", pin);
+
+    if (!m_touched[pin])
+    {
+        m_touched[pin]     = true;
+        m_stats.responseUs = m_nowUs - m_statsStartUs;
+    }
+
+    Cell_t& cell = m_cells[pin];
+    relax(cell);
+
+    // voltage across the segment, positive colors, negative bleaches
+    int   cellVoltage = high ? (m_appConfig->highPinVoltage - common) : -common;
+    float target      = cellVoltage > 0 ? 1.0f : 0.0f;
+    float rate        = (float)std::abs(cellVoltage) / (m_appConfig->maxSegmentVoltage * cell.chargeTau);
+
+    cell.charge += (target - cell.charge) * (1.0f - std::exp(-rate * (float)durationUs / 1000));
+    m_nowUs += durationUs;
+    cell.lastUs = m_nowUs;
+    trace(m_nowUs, "pulse end", pin);
+
+    m_stats.busyUs += m_nowUs - start;
+}
+
+int SimHAL::analogRead(int pin)
+{
+    int val = -1;
+    (void)analogReadMany(&pin, 1, &val);
+    return val;
+}
+
+esp_err_t SimHAL::analogReadMany(const int* pins, size_t count, int* values)
+{
+    int samples = std::clamp(m_appConfig->analogSamples, 1, MAX_SAMPLES);
+
+    int64_t start = m_nowUs;
+    m_nowUs += m_config.muxSwitchUs;  // the mux stays enabled for the whole scan, like in HAL
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(pins[i] > 0 && pins[i] < CHANNEL_COUNT);
+
+        m_stats.analogReads++;
+        m_nowUs += (int64_t)m_config.adcReadUs * samples;
+
+        std::array<int, MAX_SAMPLES> vals {};
+        for (int s = 0; s < samples; ++s)
+        {
+            vals[s] = sample(pins[i]);
+        }
+        std::nth_element(vals.begin(), vals.begin() + samples / 2, vals.begin() + samples);
+        values[i] = vals[samples / 2];
+
+        ESP_LOGD(TAG, "analogRead: pin=%d val=%d", pins[i], values[i]);
+    }
+
+    m_stats.busyUs += m_nowUs - start;
+    return ESP_OK;
+}
+
+int SimHAL::sample(int pin)
+{
+    Cell_t& cell = m_cells[pin];
+    relax(cell);
+
+    int   maxAnalog = (1 << m_appConfig->analogResolution) - 1;
+    float ocv       = BLEACHED_OCV + cell.charge * (COLORED_OCV - BLEACHED_OCV);
+    int   noise     = (int)(random() % (2 * m_config.noiseLsb + 1)) - m_config.noiseLsb;
+    return std::clamp((int)(ocv * maxAnalog) + noise, 0, maxAnalog);
+}
+
+void SimHAL::resetStats()
+{
+    m_stats        = {};
+    m_statsStartUs = m_nowUs;
+    m_touched.fill(false);
+}
+
+float SimHAL::getCharge(int pin)
+{
+    assert(pin > 0 && pin < CHANNEL_COUNT);
+    relax(m_cells[pin]);
+    return m_cells[pin].charge;
+}
+
+void SimHAL::setCharge(int pin, float charge)
+{
+    assert(pin > 0 && pin < CHANNEL_COUNT);
+    m_cells[pin].charge = std::clamp(charge, 0.0f, 1.0f);
+    m_cells[pin].lastUs = m_nowUs;
+}
+
+void SimHAL::wear(int pin, float factor)
+{
+    assert(pin > 0 && pin < CHANNEL_COUNT);
+    assert(factor >= 1.0f);
+    relax(m_cells[pin]);
+    m_cells[pin].chargeTau *= factor;
+    m_cells[pin].relaxTau /= factor;
+}
+
+void SimHAL::startTrace()
+{
+    m_traceCount   = 0;
+    m_traceStartUs = m_nowUs;
+    m_tracing      = true;
+}
+
+void SimHAL::printTrace() const
+{
+    for (size_t i = 0; i < m_traceCount; ++i)
+    {
+        printf("%8" PRId64 " us | %-15s | %d\n", m_trace[i].us - m_traceStartUs, m_trace[i].event, m_trace[i].value);
+    }
+}
+
+void SimHAL::trace(int64_t us, const char* event, int value)
+{
+    if (m_tracing && m_traceCount < m_trace.size())
+    {
+        m_trace[m_traceCount++] = {.us = us, .event = event, .value = value};
+    }
+}
+
+void SimHAL::relax(Cell_t& cell)
+{
+    float elapsedMs = (float)(m_nowUs - cell.lastUs) / 1000;
+    cell.charge     = REST_CHARGE + (cell.charge - REST_CHARGE) * std::exp(-elapsedMs / cell.relaxTau);
+    cell.lastUs     = m_nowUs;
+}
+
+uint32_t SimHAL::random()
+{
+    // xorshift32, deterministic for reproducible runs
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    return m_rng;
+}
+
+}  // namespace hal
+}  // namespace app
@@ -0,0 +1,166 @@
+/**
+ * @file sim_hal.hpp
+ * @brief Simulated HAL with an electrochemical segment model for off-target testing and benchmarking
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ *
+ * SimHAL replaces the CD74HC4067 + MCP4725 hardware with a model of the ECD segments.
+ * Each multiplexer channel is an RC/charge-state cell: driving it moves its charge towards the
+ * colored or bleached state, leaving it open lets it relax slowly. analogRead returns the
+ * open-circuit voltage of the cell in ADC units.
+ *
+ * Time is virtual: pulses and bus transactions advance an internal clock instead of blocking,
+ * so thousands of update cycles run per second of wall time. pulse() is the dry-run of the
+ * hardware pulse engine, pulse widths are applied with microsecond resolution.
+ */
+
+#pragma once
+
+#include <array>
+#include <cinttypes>
+
+#include "app_config.hpp"
+#include "esp_err.h"
+#include "ynv_hal.hpp"
+
+namespace app
+{
+namespace hal
+{
+
+class SimHAL : public ynv::driver::HALBase
+{
+   public:
+    /**
+     * @brief Segment model and bus timing parameters
+     */
+    struct Config_t
+    {
+        int      chargeTauMs;   // charge time constant of a segment at maxSegmentVoltage
+        int      relaxTauMs;    // open-circuit relaxation time constant
+        int      tauSpreadPct;  // per-segment spread of the time constants (+/- %)
+        int      noiseLsb;      // ADC noise amplitude (+/- LSB)
+        int      dacWriteUs;    // cost of a DAC write (I2C transaction)
+        int      adcReadUs;     // cost of an ADC conversion
+        int      muxSwitchUs;   // cost of select + enable + disable, once per analogReadMany scan
+        bool     asyncDac;      // DAC transfer overlaps with the mux setup, like in HAL
+        uint32_t seed;          // seed for segment spread and noise
+    };
+
+    /**
+     * @brief Timing trace entry, recorded between startTrace and the end of the trace buffer
+     */
+    struct TraceEvent_t
+    {
+        int64_t     us;     // virtual time
+        const char* event;  // what happened
+        int         value;  // channel or DAC code
+    };
+
+    /**
+     * @brief HAL call counters
+     */
+    struct Stats_t
+    {
+        uint32_t digitalWrites;  // digitalWrite calls
+        uint32_t dacWrites;      // DAC (common electrode) writes, unchanged codes are not counted
+        uint32_t analogReads;    // channels read with analogRead/analogReadMany
+        int64_t  busyUs;         // virtual time spent inside HAL calls
+        int64_t  responseUs;     // virtual time until the last written channel received its first pulse
+    };
+
+    /** @brief Default model: ~150ms charge constant, ~2min memory, 100kHz I2C */
+    static constexpr Config_t DEFAULT_CONFIG = {
+        .chargeTauMs  = 150,
+        .relaxTauMs   = 120000,
+        .tauSpreadPct = 20,
+        .noiseLsb     = 8,
+        .dacWriteUs   = 300,
+        .adcReadUs    = 40,
+        .muxSwitchUs  = 10,
+        .asyncDac     = true,
+        .seed         = 1,
+    };
+
+    static constexpr int    CHANNEL_COUNT  = 16;  // CD74HC4067 channels, channel-0 is not connected
+    static constexpr size_t TRACE_CAPACITY = 32;  // trace entries kept after startTrace
+
+    SimHAL()
+        : m_config(DEFAULT_CONFIG), m_stats(), m_statsStartUs(0), m_nowUs(0), m_rng(1), m_lastCommon(-1), m_cells(),
+          m_touched(), m_trace(), m_traceCount(0), m_traceStartUs(0), m_tracing(false)
+    {
+    }
+    ~SimHAL() = default;
+
+    esp_err_t init(ynv::app::AppConfig_t* appConfig, const Config_t& config = DEFAULT_CONFIG);
+
+    esp_err_t digitalWrite(int pin, bool high, int delay = 10, int common = 0) override;
+    esp_err_t pulse(const ynv::driver::Pulse_t* pulses, size_t count) override;
+    int       analogRead(int pin) override;
+    esp_err_t analogReadMany(const int* pins, size_t count, int* values) override;
+
+    /** @brief Virtual time since init (microseconds) */
+    int64_t micros() override { return m_nowUs; }
+
+    /** @brief Let virtual time pass without any HAL activity (e.g. between animation ticks) */
+    void advance(int64_t us) { m_nowUs += us; }
+
+    const Stats_t& getStats() const { return m_stats; }
+    void           resetStats();
+
+    /**
+     * @brief Charge state of a segment
+     * @return 0.0 (fully bleached) .. 1.0 (fully colored)
+     */
+    float getCharge(int pin);
+
+    /** @brief Force the charge state of a segment (0.0 .. 1.0) */
+    void setCharge(int pin, float charge);
+
+    /**
+     * @brief Age a segment: it charges factor times slower and relaxes factor times faster
+     * @param pin Segment channel
+     * @param factor Wear factor (1=new)
+     */
+    void wear(int pin, float factor);
+
+    /** @brief Clear the trace and record the next TRACE_CAPACITY pulse timing events */
+    void startTrace();
+
+    /** @brief Print the recorded trace, times relative to startTrace */
+    void printTrace() const;
+
+    static constexpr const char* TAG = "SimHAL";
+
+   private:
+    struct Cell_t
+    {
+        float   charge;     // 0.0 bleached .. 1.0 colored
+        float   chargeTau;  // ms, at maxSegmentVoltage
+        float   relaxTau;   // ms
+        int64_t lastUs;     // virtual time of the last state evaluation
+    };
+
+    Config_t                          m_config;
+    Stats_t                           m_stats;
+    int64_t                           m_statsStartUs;  // virtual time of the last resetStats
+    int64_t                           m_nowUs;
+    uint32_t                          m_rng;
+    int                               m_lastCommon;  // last DAC code, writes are skipped if unchanged like in HAL
+    std::array<Cell_t, CHANNEL_COUNT> m_cells;
+    std::array<bool, CHANNEL_COUNT>   m_touched;  // channel written since resetStats
+
+    std::array<TraceEvent_t, TRACE_CAPACITY> m_trace;
+    size_t                                   m_traceCount;
+    int64_t                                  m_traceStartUs;
+    bool                                     m_tracing;
+
+    void     relax(Cell_t& cell);                                             // apply relaxation up to now
+    void     drivePulse(int pin, bool high, int64_t durationUs, int common);  // dry-run of one pulse
+    void     trace(int64_t us, const char* event, int value);                 // record a trace event
+    int      sample(int pin);                                                 // one noisy ADC conversion
+    uint32_t random();
+};
+
+}  // namespace hal
+}  // namespace app
@@ -9,6 +9,7 @@
 
 #include <array>
 
+#include "anim.hpp"
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
 #include "lvgl.h"
@@ -56,9 +57,71 @@ esp_err_t GUI::show()
         addAnimationButtons(tv, static_cast<app::disp::ECD_t>(i));
     }
 
+    // animation state arrives as events, the anim task never waits for the display lock
+    ESP_ERROR_CHECK(ynv::driver::EventBus::getInstance().subscribe(m_events));
+    lv_timer_create(pollEvents, EVENT_POLL_MS, this);
+
     return ESP_OK;
 }
 
+void GUI::pollEvents(lv_timer_t* timer)
+{
+    using State_t = ynv::anim::AnimBase::State_t;
+
+    GUI&                 gui = *static_cast<GUI*>(lv_timer_get_user_data(timer));
+    ynv::driver::Event_t event;
+    uint32_t             dropped = gui.m_events.dropped;
+
+    // last state per display, events carry the display as source
+    std::array<const char*, ynv::ecd::EvalkitDisplays::EVALKIT_DISP_CNT> texts = {};
+
+    while (ynv::driver::EventBus::getInstance().poll(gui.m_events, event))
+    {
+        if (event.source >= texts.size())
+        {
+            continue;
+        }
+        switch (event.type)
+        {
+            case ynv::driver::EVENT_ANIM_STATE:
+                switch (static_cast<State_t>(event.value))
+                {
+                    case State_t::RUNNING:
+                        texts[event.source] = "#00ff00 Playing#";
+                        break;
+                    case State_t::PAUSED:
+                        texts[event.source] = "#ffa500 Paused#";
+                        break;
+                    case State_t::IDLE:
+                        texts[event.source] = "#ff0000 Select#";
+                        break;
+                    default:
+                        break;
+                }
+                break;
+            case ynv::driver::EVENT_REFRESH_TIMEOUT:
+                ESP_LOGW(GUI::TAG, "Display %u refresh timed out after %" PRId32 " retries", event.source,
+                         event.value);
+                break;
+            default:
+                break;
+        }
+    }
+    if (gui.m_events.dropped != dropped)
+    {
+        ESP_LOGW(GUI::TAG, "%" PRIu32 " events dropped", gui.m_events.dropped - dropped);
+    }
+
+    // only the last state counts, the timer runs with the LVGL lock held
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        if (texts[i] != nullptr && gui.m_statusLabels[i] != nullptr)
+        {
+            lv_label_set_text(gui.m_statusLabels[i], texts[i]);
+        }
+    }
+}
+
 static void btnEventHandler(lv_event_t* e)
 {
     lv_event_code_t code = lv_event_get_code(e);
@@ -68,9 +131,6 @@ static void btnEventHandler(lv_event_t* e)
         GUI::BtnInfo_t& btnInfo = *static_cast<GUI::BtnInfo_t*>(lv_event_get_user_data(e));
         ESP_LOGI(GUI::TAG, "Button event (%s)", btnInfo.animInfo->animName);
 
-        // btnInfo.checked = !btnInfo.checked;
-        // lv_label_set_text(btnInfo.statusLabel, btnInfo.checked ? "#00ff00 Playing#" : "#ff0000 Select#");
-
         if (btnInfo.animHandler)
         {
             btnInfo.animHandler(e);
@@ -101,6 +161,15 @@ esp_err_t GUI::addAnimationButtons(lv_obj_t* tv, app::disp::ECD_t display)
             [this](lv_event_t* e)
             {
                 GUI::BtnInfo_t& btnInfo = *static_cast<GUI::BtnInfo_t*>(lv_event_get_user_data(e));
+
+                // tiles share evalkit displays, the events of a display go to the tile that selected it last
+                lv_obj_t*& active = m_statusLabels[btnInfo.animInfo->displayType];
+                if (active != nullptr && active != btnInfo.statusLabel)
+                {
+                    lv_label_set_text(active, "#ff0000 Select#");
+                }
+                active = btnInfo.statusLabel;
+
                 if (m_animHandler != nullptr)
                 {
                     ESP_LOGI(GUI::TAG, "Calling animation handler for animation: %s", btnInfo.animInfo->animName);
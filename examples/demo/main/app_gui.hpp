@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <array>
 #include <cinttypes>
 #include <cstdlib>
 #include <cstring>
@@ -17,6 +18,7 @@
 #include "bsp/esp-bsp.h"
 #include "disp_images.hpp"
 #include "esp_err.h"
+#include "ynv_event_bus.hpp"
 
 namespace app
 {
@@ -92,8 +94,22 @@ class GUI
     esp_err_t show();
     esp_err_t addAnimationButtons(lv_obj_t* tv, app::disp::ECD_t display);
 
+    /**
+     * @brief Show the animation events published since the last call on the status labels (LVGL timer)
+     * @param timer LVGL timer, user data is the GUI
+     */
+    static void pollEvents(lv_timer_t* timer);
+
+    /** @brief Event poll period (ms) */
+    static constexpr uint32_t EVENT_POLL_MS = 100;
+
+    /** @brief Status label of the tile that last selected each evalkit display, indexed by event source */
+    using StatusLabels_t = std::array<lv_obj_t*, ynv::ecd::EvalkitDisplays::EVALKIT_DISP_CNT>;
+
     static constexpr size_t                                  MAX_BTN_INFOS = 64;
     std::vector<BtnInfo_t>                                   btnInfos;
+    StatusLabels_t                                           m_statusLabels = {};  ///< Status label per display
+    ynv::driver::Subscriber_t                                m_events = {0, 0};    ///< Animation and drive events
     std::function<void(const app::disp::DisplayAnimInfo_t*)> m_animHandler = nullptr;
 };
 }  // namespace app
\ No newline at end of file
@@ -9,14 +9,17 @@
  * the GUI, and manages electrochromic display animations.
  */
 
+#include "anim_scheduler.hpp"
 #include "app_gui.hpp"
 #include "app_hal.hpp"
 #include "bsp/esp-bsp.h"
+#include "ecd_drive_task.hpp"
 #include "esp_log.h"
 #include "evalkit_anims.hpp"
 #include "evalkit_displays.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "nvs_flash.h"
 
 /**
  * @brief Anonymous namespace containing global singleton instances
@@ -35,27 +38,18 @@ ynv::app::AppConfig_t appConfig;
 /** @brief Animation manager singleton instance */
 auto& anims = ynv::anim::EvalkitAnims::getInstance();
 
+/** @brief Animation scheduler singleton instance */
+auto& scheduler = ynv::anim::AnimScheduler::getInstance();
+
 /** @brief Display manager singleton instance */
 auto& displays = ynv::ecd::EvalkitDisplays::getInstance();
 
 /** @brief Hardware abstraction layer singleton instance */
 auto& hal = app::hal::HAL::getInstance();
-}  // namespace
 
-/**
- * @brief FreeRTOS task for updating electrochromic display animations
- *
- * This task runs continuously and updates the current animation state every second.
- * It checks if an animation is selected and calls its update method to advance
- * the animation sequence.
- *
- * @param pvParameters Task parameters (unused)
- *
- * @note This task has a 1-second update interval (1000ms)
- * @note Task priority is set to 5 in app_main()
- * @note Task stack size is 4096 bytes
- */
-static void animTask(void* pvParameters);
+/** @brief Period of the segment health save check (ms) */
+constexpr uint32_t HEALTH_SAVE_PERIOD_MS = 10000;
+}  // namespace
 
 /**
  * @brief Main application entry point
@@ -67,17 +61,19 @@ static void animTask(void* pvParameters);
  * 2. Initializes I2C bus for communication with DAC
  * 3. Sets up GUI system with touch interface
  * 4. Configures HAL with multiplexer and DAC settings
- * 5. Initializes ECD display management
- * 6. Registers button event handlers for animation control
- * 7. Creates FreeRTOS task for animation updates
+ * 5. Initializes ECD display management and the background drive task
+ * 6. Starts the animation scheduler task
+ * 7. Registers button event handlers for animation control
+ * 8. Saves the learned segment health to NVS when due
  *
  * @note Hardware Configuration:
  *       - CD74HC4067 multiplexer on GPIOs 9,11,13,14 (select) + 10 (signal) + 12 (enable)
  *       - MCP4725 DAC on I2C (SDA: GPIO38, SCL: GPIO41, Address: 0x60)
- *       - I2C frequency: 100kHz
+ *       - I2C frequency: 400kHz (Fast Mode)
  *
  * @note Software Configuration:
- *       - Active driving mode enabled
+ *       - Active driving mode enabled, with segment health tracking (NVS)
+ *         and drift-predictive hysteresis refresh
  *       - 12-bit analog resolution for voltage measurements
  *       - Maximum segment voltage and high pin voltage set to default values
  */
@@ -86,7 +82,11 @@ extern "C" void app_main(void)
     // Configure application settings
     appConfig.hal               = &hal;
     appConfig.activeDriving     = true;  ///< Enable active driving for precise ECD control
+    appConfig.segmentHealth     = true;  ///< Compensate slow segments, budget failing ones
+    appConfig.predictiveRefresh = true;  ///< Refresh unchanged segments only before they leave the window
+    appConfig.hysteresisRefresh = true;  ///< Drive a segment back only once it left the refresh window
     appConfig.analogResolution  = 12;    ///< Use 12-bit ADC resolution
+    appConfig.analogSamples     = 5;     ///< Median of 5 ADC samples per analog read
     appConfig.maxSegmentVoltage = ynv::app::AppConfig_t::MAX_SEGMENT_VOLTAGE;  ///< Set maximum allowed segment voltage
     appConfig.highPinVoltage    = ynv::app::AppConfig_t::HIGH_PIN_VOLTAGE;     ///< Set high pin voltage level
 
@@ -106,52 +106,49 @@ extern "C" void app_main(void)
               .signal = GPIO_NUM_10,   ///< Multiplexer analog signal pin
               .enable = GPIO_NUM_12},  ///< Multiplexer enable pin
              // MCP4725 12-bit I2C DAC configuration
-             {.busHandle  = nullptr,      ///< I2C bus handle (will be initialized)
-              .i2cPort    = 0,            ///< I2C port number
-              .i2cAddr    = 0x60,         ///< MCP4725 I2C device address
-              .i2cSdaGpio = GPIO_NUM_38,  ///< I2C data line GPIO
-              .i2cSclGpio = GPIO_NUM_41,  ///< I2C clock line GPIO
-              .i2cFreqHz  = 100000});      ///< I2C bus frequency (100kHz)
+             {.busHandle  = nullptr,                             ///< I2C bus handle (will be initialized)
+              .i2cPort    = 0,                                   ///< I2C port number
+              .i2cAddr    = 0x60,                                ///< MCP4725 I2C device address
+              .i2cSdaGpio = GPIO_NUM_38,                         ///< I2C data line GPIO
+              .i2cSclGpio = GPIO_NUM_41,                         ///< I2C clock line GPIO
+              .i2cFreqHz  = 400000,                              ///< I2C bus frequency (400kHz)
+              .busMode    = app::hal::MCP4725::BUS_MODE_FAST});  ///< I2C Fast Mode
+
+    // Initialize NVS, the segment health records of active driving are kept there
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
 
     // Initialize electrochromic display management
     displays.init(&appConfig);
 
+    // Drive the displays in the background so that the anim task stays responsive
+    ESP_ERROR_CHECK(ynv::ecd::ECDDriveTask::getInstance().init());
+    anims.setAsyncUpdate(true);
+
+    // Step the animations when they are due, update the displays every second in between for refresh
+    anims.setRefreshInterval(1000);
+    ESP_ERROR_CHECK(scheduler.init());
+
     // Register GUI button event handler for animation selection
     m_gui.registerButtonHandler(
         [](const app::disp::DisplayAnimInfo_t* info)
         {
             if (info != nullptr)
             {
-                // Start the selected animation on the specified display
-                anims.select(info->displayType, info->animType);
+                // Start the selected animation on the specified display, in the scheduler task
+                (void)scheduler.select(info->displayType, info->animType);
             }
         });
 
-    // Create FreeRTOS task for animation updates
-    (void)xTaskCreate(animTask,       ///< Task function pointer
-                      "anim-update",  ///< Task name for debugging
-                      4096,           ///< Stack size in bytes
-                      nullptr,        ///< Task parameters (none)
-                      5,              ///< Task priority (0-24, higher = more priority)
-                      nullptr);       ///< Task handle (not needed)
-}
-
-static void animTask(void* pvParameters)
-{
-    /**
-     * Main animation update loop
-     * Continuously checks for active animations and updates their state.
-     */
-    while (true)
+    // Write the learned segment health to NVS when due, app_main runs below the animation and drive tasks
+    for (;;)
     {
-        // Check if an animation is currently selected and active
-        if (anims.isSelected())
-        {
-            // Update the current animation state (advance to next frame/step)
-            anims.getCurrentAnim().update();
-        }
-
-        // Wait 1 second before next update (1000ms in FreeRTOS ticks)
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        vTaskDelay(pdMS_TO_TICKS(HEALTH_SAVE_PERIOD_MS));
+        (void)displays.saveHealth();  // failures are logged, the records stay due
     }
 }
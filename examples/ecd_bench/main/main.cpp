@@ -0,0 +1,355 @@
+/**
+ * @file main.cpp
+ * @brief Update latency benchmark for all EvalKit displays and driving modes
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ *
+ * This application runs every EvalkitDisplays::ECDEvalkitDisplay_t through a set of
+ * representative state changes under every driving mode, using SimHAL on the
+ * ESP-IDF linux target. For each combination it measures one ECD::update() call and
+ * reports the (virtual) drive and response time, host wall time, HAL call counts and refresh retries.
+ *
+ * Results are printed as a table and written as a JSON array to CONFIG_ECD_BENCH_OUTPUT_FILE,
+ * so that CI can compare runs and catch regressions.
+ */
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "esp_log.h"
+#include "evalkit_displays.hpp"
+#include "sim_hal.hpp"
+
+/** @brief Log tag for ESP-IDF logging system */
+static const char* TAG = "ecd_bench";
+
+namespace
+{
+using ECDEvalkitDisplay_t = ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t;
+
+/** @brief Display names in the result file, indexed by ECDEvalkitDisplay_t */
+constexpr std::array<const char*, ynv::ecd::EvalkitDisplays::EVALKIT_DISP_CNT> DISPLAY_NAMES = {
+    "single_segment", "three_segment_bar", "seven_segment_bar", "dot_number",
+    "decimal_number", "signed_number",     "test"};
+
+/**
+ * @brief Driving modes
+ */
+enum DriveMode_t
+{
+    MODE_PASSIVE = 0,      ///< ECDDrivePassive
+    MODE_PASSIVE_DELTA,    ///< ECDDrivePassiveDelta
+    MODE_INTERLEAVED,      ///< ECDDriveInterleaved
+    MODE_ACTIVE,           ///< ECDDriveActive
+    MODE_ACTIVE_ADAPTIVE,  ///< ECDDriveActive with adaptive refresh
+    MODE_CNT
+};
+
+/** @brief Driving mode names in the result file, indexed by DriveMode_t */
+constexpr std::array<const char*, MODE_CNT> MODE_NAMES = {"passive", "delta", "interleaved", "active",
+                                                          "active_adaptive"};
+
+/**
+ * @brief Benchmark scenarios (start state -> measured change)
+ */
+enum Scenario_t
+{
+    SCENARIO_FULL_SET = 0,  ///< all bleached -> set()
+    SCENARIO_FULL_RESET,    ///< all colored -> reset()
+    SCENARIO_DIGIT_CHANGE,  ///< one step of the display's counter (one digit, one bar position)
+    SCENARIO_TOGGLE,        ///< counter pattern -> toggle()
+    SCENARIO_STEADY,        ///< counter pattern -> no change (refresh only)
+    SCENARIO_CNT
+};
+
+/** @brief Scenario names in the result file, indexed by Scenario_t */
+constexpr std::array<const char*, SCENARIO_CNT> SCENARIO_NAMES = {"full_set", "full_reset", "digit_change", "toggle",
+                                                                  "steady"};
+
+/**
+ * @brief Measurement of a single update() call
+ */
+struct BenchResult_t
+{
+    ECDEvalkitDisplay_t display;         ///< Display type
+    DriveMode_t         mode;            ///< Driving mode
+    Scenario_t          scenario;        ///< Scenario
+    int                 segments;        ///< Segment count of the display
+    int64_t             driveUs;         ///< Virtual (on-device) time spent in update()
+    int64_t             responseUs;      ///< Virtual time until every pulsed segment received its first pulse
+    int64_t             wallUs;          ///< Host time spent in update()
+    uint32_t            digitalWrites;   ///< HAL digitalWrite calls
+    uint32_t            dacWrites;       ///< DAC writes
+    uint32_t            analogReads;     ///< Channels read by the HAL
+    int                 refreshRetries;  ///< Refresh iterations
+};
+
+/**
+ * @brief Create and initialise a display, same setup as EvalkitDisplays::init
+ * @param type Display type
+ * @param appConfig Application configuration
+ * @param segments Segment count of the created display
+ * @return Display instance
+ */
+std::shared_ptr<ynv::ecd::ECDBase> createDisplay(ECDEvalkitDisplay_t type, const ynv::app::AppConfig_t* appConfig,
+                                                 int& segments)
+{
+    using namespace ynv::ecd;
+
+    std::shared_ptr<ECDBase> display;
+    switch (type)
+    {
+        case EvalkitDisplays::EVALKIT_DISP_SINGLE_SEGMENT_DISPLAY:
+            display  = std::make_shared<DispSingleSegment>(&DispSingleSegment::PINS, appConfig);
+            segments = DispSingleSegment::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_THREE_SEGMENT_BAR_DISPLAY:
+            display  = std::make_shared<Disp3SegBar>(&Disp3SegBar::PINS, appConfig);
+            segments = Disp3SegBar::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_SEVEN_SEGMENT_BAR_DISPLAY:
+            display  = std::make_shared<Disp7SegBar>(&Disp7SegBar::PINS, appConfig);
+            segments = Disp7SegBar::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_DOT_NUMBER_DISPLAY:
+            display  = std::make_shared<DispDotNumber>(&DispDotNumber::PINS, appConfig);
+            segments = DispDotNumber::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_DECIMAL_NUMBER_DISPLAY:
+            display  = std::make_shared<DispDecimalNumber>(&DispDecimalNumber::PINS, appConfig);
+            segments = DispDecimalNumber::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_SIGNED_NUMBER_DISPLAY:
+            display  = std::make_shared<DispSignedNumber>(&DispSignedNumber::PINS, appConfig);
+            segments = DispSignedNumber::PINS.size();
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_TEST:
+        default:
+            display  = std::make_shared<DispTest>(&DispTest::PINS, appConfig);
+            segments = DispTest::PINS.size();
+            break;
+    }
+    display->init();
+    return display;
+}
+
+/**
+ * @brief Show one step of the display's counter animation
+ * @param display Display instance
+ * @param type Display type
+ * @param step Counter step
+ */
+void showStep(ynv::ecd::ECDBase& display, ECDEvalkitDisplay_t type, int step)
+{
+    using namespace ynv::ecd;
+
+    switch (type)
+    {
+        case EvalkitDisplays::EVALKIT_DISP_SINGLE_SEGMENT_DISPLAY:
+            if (step % 2)
+            {
+                static_cast<DispSingleSegment&>(display).on();
+            }
+            else
+            {
+                static_cast<DispSingleSegment&>(display).off();
+            }
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_THREE_SEGMENT_BAR_DISPLAY:
+            static_cast<Disp3SegBar&>(display).position(1 + step);
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_SEVEN_SEGMENT_BAR_DISPLAY:
+        {
+            auto& bar = static_cast<Disp7SegBar&>(display);
+            bar.resetPos();
+            for (int i = 0; i < 3 + step; ++i)
+            {
+                bar.increment();
+            }
+            break;
+        }
+        case EvalkitDisplays::EVALKIT_DISP_DOT_NUMBER_DISPLAY:
+            static_cast<DispDotNumber&>(display).show(3 + step);
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_DECIMAL_NUMBER_DISPLAY:
+            static_cast<DispDecimalNumber&>(display).show(4, 2 + step);
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_SIGNED_NUMBER_DISPLAY:
+            static_cast<DispSignedNumber&>(display).show(4, 2 + step, false);
+            break;
+        case EvalkitDisplays::EVALKIT_DISP_TEST:
+        default:
+            static_cast<DispTest&>(display).show(2 + step);
+            break;
+    }
+}
+
+/**
+ * @brief Measure one update() for a display, driving mode and scenario
+ *
+ * Every run uses a fresh SimHAL and display so that results are reproducible.
+ */
+BenchResult_t run(ECDEvalkitDisplay_t type, DriveMode_t mode, Scenario_t scenario)
+{
+    ynv::app::AppConfig_t appConfig = {};
+    appConfig.activeDriving         = mode == MODE_ACTIVE || mode == MODE_ACTIVE_ADAPTIVE;
+    appConfig.adaptiveRefresh       = mode == MODE_ACTIVE_ADAPTIVE;
+    appConfig.deltaDriving          = mode == MODE_PASSIVE_DELTA;
+    appConfig.interleavedDriving    = mode == MODE_INTERLEAVED;
+    appConfig.subPulseMs            = CONFIG_ECD_BENCH_SUB_PULSE_MS;
+    appConfig.analogResolution      = 12;
+
+    app::hal::SimHAL hal;
+    hal.init(&appConfig);
+
+    BenchResult_t result = {};
+    result.display       = type;
+    result.mode          = mode;
+    result.scenario      = scenario;
+
+    auto display = createDisplay(type, &appConfig, result.segments);
+
+    // bring the display to the start state
+    switch (scenario)
+    {
+        case SCENARIO_FULL_SET:
+            display->reset();
+            break;
+        case SCENARIO_FULL_RESET:
+            display->set();
+            break;
+        default:
+            showStep(*display, type, 0);
+            break;
+    }
+    display->update();
+    hal.advance((int64_t)CONFIG_ECD_BENCH_SETTLE_MS * 1000);
+
+    // measured change
+    switch (scenario)
+    {
+        case SCENARIO_FULL_SET:
+            display->set();
+            break;
+        case SCENARIO_FULL_RESET:
+            display->reset();
+            break;
+        case SCENARIO_DIGIT_CHANGE:
+            showStep(*display, type, 1);
+            break;
+        case SCENARIO_TOGGLE:
+            display->toggle();
+            break;
+        default:
+            break;
+    }
+
+    hal.resetStats();
+    int64_t start     = hal.micros();
+    auto    wallStart = std::chrono::steady_clock::now();
+
+    display->update();
+
+    result.wallUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wallStart).count();
+    result.driveUs        = hal.micros() - start;
+    result.responseUs     = hal.getStats().responseUs;
+    result.digitalWrites  = hal.getStats().digitalWrites;
+    result.dacWrites      = hal.getStats().dacWrites;
+    result.analogReads    = hal.getStats().analogReads;
+    ynv::ecd::DriveStats_t stats;
+    display->getDriveStats(stats);
+    result.refreshRetries = stats.refreshRetries;
+    return result;
+}
+
+/**
+ * @brief Write results as a JSON array
+ */
+void writeJson(FILE* f, const std::vector<BenchResult_t>& results)
+{
+    fprintf(f, "[\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        fprintf(f,
+                "  {\"display\": \"%s\", \"mode\": \"%s\", \"scenario\": \"%s\", \"segments\": %d, "
+                "\"drive_us\": %" PRId64 ", \"response_us\": %" PRId64 ", \"wall_us\": %" PRId64
+                ", \"hal_calls\": %" PRIu32
+                ", \"digital_writes\": %" PRIu32 ", \"dac_writes\": %" PRIu32 ", \"adc_reads\": %" PRIu32
+                ", \"refresh_retries\": %d}%s\n",
+                DISPLAY_NAMES[r.display], MODE_NAMES[r.mode], SCENARIO_NAMES[r.scenario], r.segments, r.driveUs,
+                r.responseUs, r.wallUs, r.digitalWrites + r.analogReads, r.digitalWrites, r.dacWrites, r.analogReads,
+                r.refreshRetries, (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(f, "]\n");
+}
+
+/**
+ * @brief Print results as a table
+ */
+void printTable(const std::vector<BenchResult_t>& results)
+{
+    printf("%-18s | %-15s | %-12s | %4s | %10s | %11s | %8s | %6s | %6s | %6s | %7s\n", "display", "mode", "scenario",
+           "segs", "drive ms", "response ms", "wall us", "writes", "dac", "reads", "retries");
+    for (const auto& r : results)
+    {
+        printf("%-18s | %-15s | %-12s | %4d | %10.1f | %11.1f | %8" PRId64 " | %6" PRIu32 " | %6" PRIu32 " | %6" PRIu32
+               " | %7d\n",
+               DISPLAY_NAMES[r.display], MODE_NAMES[r.mode], SCENARIO_NAMES[r.scenario], r.segments,
+               (double)r.driveUs / 1000, (double)r.responseUs / 1000, r.wallUs, r.digitalWrites, r.dacWrites,
+               r.analogReads, r.refreshRetries);
+    }
+}
+}  // namespace
+
+/**
+ * @brief Main application entry point for the benchmark
+ *
+ * Runs all display / driving mode / scenario combinations, prints the results and
+ * writes them to CONFIG_ECD_BENCH_OUTPUT_FILE.
+ */
+extern "C" void app_main(void)
+{
+    std::vector<BenchResult_t> results;
+    results.reserve((size_t)ynv::ecd::EvalkitDisplays::EVALKIT_DISP_CNT * (size_t)MODE_CNT * (size_t)SCENARIO_CNT);
+
+    for (int d = 0; d < ynv::ecd::EvalkitDisplays::EVALKIT_DISP_CNT; ++d)
+    {
+        for (int m = 0; m < MODE_CNT; ++m)
+        {
+            for (int s = 0; s < SCENARIO_CNT; ++s)
+            {
+                results.push_back(
+                    run(static_cast<ECDEvalkitDisplay_t>(d), static_cast<DriveMode_t>(m), static_cast<Scenario_t>(s)));
+            }
+        }
+    }
+
+    printTable(results);
+
+    const char* path = CONFIG_ECD_BENCH_OUTPUT_FILE;
+    if (path[0] != '\0')
+    {
+        FILE* f = fopen(path, "w");
+        if (f == nullptr)
+        {
+            ESP_LOGE(TAG, "Failed to open %s", path);
+            exit(EXIT_FAILURE);
+        }
+        writeJson(f, results);
+        fclose(f);
+        ESP_LOGI(TAG, "Results written to %s", path);
+    }
+    else
+    {
+        writeJson(stdout, results);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -9,11 +9,14 @@
  * animation systems.
  */
 
+#include "anim_scheduler.hpp"
 #include "app_hal.hpp"
 #include "evalkit_anims.hpp"
 #include "evalkit_displays.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "nvs_flash.h"
+#include "ynv_trace.hpp"
 
 /**
  * @brief Anonymous namespace containing singleton instances
@@ -34,25 +37,30 @@ auto& displays = ynv::ecd::EvalkitDisplays::getInstance();
 
 /** @brief Hardware abstraction layer singleton */
 auto& hal = app::hal::HAL::getInstance();
+
+/** @brief Period of the segment health save check (ms) */
+constexpr uint32_t HEALTH_SAVE_PERIOD_MS = 10000;
 }  // namespace
 
 /**
  * @brief Main application entry point for display testing
  *
  * Initializes the hardware abstraction layer, display system, and runs
- * a continuous animation test loop. This provides a minimal environment
+ * a continuous animation test in the animation scheduler task. This provides a minimal environment
  * for testing ECD functionality without GUI overhead.
  *
  * Test Configuration:
  * - Uses EVALKIT_DISP_TEST display type
  * - Runs ANIM_TOGGLE animation continuously
- * - Updates every 1 second
+ * - Toggles every 5 seconds, updates the display every 1 second in between
  *
  * @note Hardware Configuration:
  *       - CD74HC4067 multiplexer on GPIOs 9,11,13,14 (select) + 10 (signal) + 12 (enable)
- *       - MCP4725 DAC on I2C (SDA: GPIO38, SCL: GPIO41, Address: 0x60, 100kHz)
+ *       - MCP4725 DAC on I2C (SDA: GPIO38, SCL: GPIO41, Address: 0x60, 400kHz Fast Mode)
  *
- * @note Driving mode is configurable via menuconfig (CONFIG_ECD_DRIVING_ACTIVE)
+ * @note Driving mode is configurable via menuconfig (CONFIG_ECD_DRIVING_ACTIVE, CONFIG_ECD_ADAPTIVE_REFRESH,
+ *       CONFIG_ECD_SEGMENT_HEALTH, CONFIG_ECD_PREDICTIVE_REFRESH, CONFIG_ECD_HYSTERESIS_REFRESH,
+ *       CONFIG_ECD_DRIVING_INTERLEAVED, CONFIG_ECD_DRIVING_DELTA)
  */
 extern "C" void app_main(void)
 {
@@ -62,11 +70,35 @@ extern "C" void app_main(void)
     // Set driving mode based on build configuration
 #ifdef CONFIG_ECD_DRIVING_ACTIVE
     appConfig.activeDriving = true;  ///< Enable active driving for precise control
+#ifdef CONFIG_ECD_ADAPTIVE_REFRESH
+    appConfig.adaptiveRefresh = true;  ///< Size refresh pulses from the learned segment response
+#endif
+#ifdef CONFIG_ECD_SEGMENT_HEALTH
+    appConfig.segmentHealth = true;  ///< Compensate slow segments, budget failing ones
+#endif
+#ifdef CONFIG_ECD_PREDICTIVE_REFRESH
+    appConfig.predictiveRefresh = true;  ///< Refresh unchanged segments only before they leave the window
+#endif
+#ifdef CONFIG_ECD_HYSTERESIS_REFRESH
+    appConfig.hysteresisRefresh = true;  ///< Drive a segment back only once it left the refresh window
+#endif
 #else
     appConfig.activeDriving = false;  ///< Use passive driving mode
 #endif
 
+#ifdef CONFIG_ECD_DRIVING_INTERLEAVED
+    appConfig.interleavedDriving = true;                     ///< Interleave sub-pulses over the changed segments
+    appConfig.subPulseMs         = CONFIG_ECD_SUB_PULSE_MS;  ///< Sub-pulse length
+#endif
+
+#ifdef CONFIG_ECD_DRIVING_DELTA
+    appConfig.deltaDriving          = true;                                ///< Pulse only changed segments
+    appConfig.maintenanceUpdates    = CONFIG_ECD_MAINTENANCE_UPDATES;      ///< Maintenance schedule (updates)
+    appConfig.maintenanceIntervalMs = CONFIG_ECD_MAINTENANCE_INTERVAL_MS;  ///< Maintenance schedule (ms)
+#endif
+
     appConfig.analogResolution  = 12;                                          ///< 12-bit ADC resolution
+    appConfig.analogSamples     = 5;                                           ///< Median of 5 ADC samples per read
     appConfig.maxSegmentVoltage = ynv::app::AppConfig_t::MAX_SEGMENT_VOLTAGE;  ///< Maximum segment voltage
     appConfig.highPinVoltage    = ynv::app::AppConfig_t::HIGH_PIN_VOLTAGE;     ///< High pin voltage level
 
@@ -80,29 +112,40 @@ extern "C" void app_main(void)
               .signal = GPIO_NUM_10,   ///< Analog signal pin
               .enable = GPIO_NUM_12},  ///< Enable control pin
              // MCP4725 DAC configuration
-             {.busHandle  = nullptr,      ///< I2C bus handle (auto-init)
-              .i2cPort    = 0,            ///< I2C port number
-              .i2cAddr    = 0x60,         ///< MCP4725 device address
-              .i2cSdaGpio = GPIO_NUM_38,  ///< I2C data line
-              .i2cSclGpio = GPIO_NUM_41,  ///< I2C clock line
-              .i2cFreqHz  = 100000});      ///< 100kHz I2C frequency
+             {.busHandle  = nullptr,                             ///< I2C bus handle (auto-init)
+              .i2cPort    = 0,                                   ///< I2C port number
+              .i2cAddr    = 0x60,                                ///< MCP4725 device address
+              .i2cSdaGpio = GPIO_NUM_38,                         ///< I2C data line
+              .i2cSclGpio = GPIO_NUM_41,                         ///< I2C clock line
+              .i2cFreqHz  = 400000,                              ///< 400kHz I2C frequency
+              .busMode    = app::hal::MCP4725::BUS_MODE_FAST});  ///< I2C Fast Mode
+
+    // Initialize NVS, the segment health records of active driving are kept there
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
 
     // Initialize display management system
     displays.init(&appConfig);
 
+    // Run the animation in the scheduler task, log the pulses and reads of every step (CONFIG_YNV_TRACE)
+    auto& scheduler = ynv::anim::AnimScheduler::getInstance();
+    scheduler.registerStepCallback([](ynv::anim::AnimBase&) { YNV_TRACE_DUMP(); });
+    anims.setRefreshInterval(1000);
+    ESP_ERROR_CHECK(scheduler.init());
+
     // Start test animation - toggle animation on test display
-    anims.select(ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t::EVALKIT_DISP_TEST,
-                 ynv::anim::EvalkitAnims::Anim_t::ANIM_TOGGLE);
-
-    /**
-     * Main test loop - continuous animation updates
-     *
-     * Runs the selected animation indefinitely with 1-second intervals,
-     * providing a simple test environment for validating ECD functionality.
-     */
-    while (true)
+    ESP_ERROR_CHECK(scheduler.select(ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t::EVALKIT_DISP_TEST,
+                                     ynv::anim::EvalkitAnims::Anim_t::ANIM_TOGGLE));
+
+    // Write the learned segment health to NVS when due, app_main runs below the animation and drive tasks
+    for (;;)
     {
-        anims.getCurrentAnim().update();  // Update animation state
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Wait 1 second between updates
+        vTaskDelay(pdMS_TO_TICKS(HEALTH_SAVE_PERIOD_MS));
+        (void)displays.saveHealth();  // failures are logged, the records stay due
     }
 }
@@ -0,0 +1,350 @@
+/**
+ * @file hal_bench.cpp
+ * @brief Microbenchmarks for the HAL drivers (CD74HC4067, MCP4725)
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "hal_bench.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdlib>
+
+#include "esp_adc/adc_oneshot.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace app
+{
+namespace bench
+{
+
+static const char* TAG = "hal_bench";
+
+static constexpr int SCAN_CHANNELS = 15;  // segments of the largest display
+static constexpr int SCAN_SAMPLES  = 5;   // oversampling of the median scan, as in the ECD examples
+
+/**
+ * @brief Print the per-switch cost of a read/write cycle benchmark
+ */
+static void report(const char* name, int iterations, int64_t elapsedUs)
+{
+    // each iteration switches the Signal pin twice (to input and back to output)
+    ESP_LOGI(TAG, "%s: %d cycles in %" PRId64 " us, %.1f us/switch", name, iterations, elapsedUs,
+             (double)elapsedUs / (2.0 * iterations));
+}
+
+void signalSwitchLegacy(gpio_num_t signal, gpio_num_t enable, int iterations)
+{
+    // keep the multiplexer disabled so that nothing is driven
+    (void)gpio_set_direction(enable, GPIO_MODE_OUTPUT);
+    (void)gpio_set_level(enable, 1);
+
+    adc_unit_t    unit;
+    adc_channel_t channel;
+    if (adc_oneshot_io_to_channel(signal, &unit, &channel) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Signal pin is not an ADC pin");
+        return;
+    }
+
+    const adc_oneshot_unit_init_cfg_t unitConfig = {
+        .unit_id = unit,
+    };
+    const adc_oneshot_chan_cfg_t chanConfig = {
+        .atten    = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    gpio_config_t ioConf = {};
+    ioConf.pin_bit_mask  = (1ull << (int)signal);
+    ioConf.intr_type     = GPIO_INTR_DISABLE;
+    ioConf.mode          = GPIO_MODE_OUTPUT;
+    ioConf.pull_down_en  = GPIO_PULLDOWN_DISABLE;
+    ioConf.pull_up_en    = GPIO_PULLUP_ENABLE;
+
+    adc_oneshot_unit_handle_t handle = nullptr;
+    int                       val    = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        // to input: release GPIO, create the ADC unit
+        (void)gpio_reset_pin(signal);
+        (void)gpio_set_pull_mode(signal, GPIO_FLOATING);
+        (void)gpio_set_direction(signal, GPIO_MODE_DISABLE);
+        (void)adc_oneshot_new_unit(&unitConfig, &handle);
+        (void)adc_oneshot_config_channel(handle, channel, &chanConfig);
+        (void)adc_oneshot_read(handle, channel, &val);
+
+        // to output: delete the ADC unit, configure GPIO
+        (void)adc_oneshot_del_unit(handle);
+        handle = nullptr;
+        (void)gpio_config(&ioConf);
+        (void)gpio_set_level(signal, 0);
+    }
+    report("signal switch (legacy, ADC unit per read)", iterations, esp_timer_get_time() - start);
+
+    (void)gpio_reset_pin(signal);
+}
+
+void signalSwitch(app::hal::CD74HC4067& mux, int iterations)
+{
+    uint16_t val = 0;
+
+    (void)mux.disable();
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        (void)mux.read(val);
+        (void)mux.write(false);
+    }
+    report("signal switch (persistent ADC unit)", iterations, esp_timer_get_time() - start);
+}
+
+/**
+ * @brief Print the per-select cost of a select benchmark
+ */
+static void reportSelect(const char* name, int iterations, int64_t elapsedUs)
+{
+    ESP_LOGI(TAG, "%s: %d selects in %" PRId64 " us, %.3f us/select", name, iterations, elapsedUs,
+             (double)elapsedUs / iterations);
+}
+
+void selectLatency(app::hal::CD74HC4067& mux, const app::hal::CD74HC4067::Config_t& config, int iterations)
+{
+    (void)mux.disable();
+
+    // one gpio_set_level per select line, the lines change one after another
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        int channel = (i & 1) ? 0x0 : 0xF;  // every line changes
+        (void)gpio_set_level(config.s0, (channel >> 0) & 1);
+        (void)gpio_set_level(config.s1, (channel >> 1) & 1);
+        (void)gpio_set_level(config.s2, (channel >> 2) & 1);
+        (void)gpio_set_level(config.s3, (channel >> 3) & 1);
+    }
+    reportSelect("mux select (legacy, gpio_set_level per line)", iterations, esp_timer_get_time() - start);
+
+    // the driver does not know what the loop above left on the lines, make it write the first channel
+    (void)mux.select(0x5);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        (void)mux.select((i & 1) ? 0x0 : 0xF);
+    }
+    reportSelect("mux select (set/clear registers)", iterations, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        (void)mux.select(0x0);
+    }
+    reportSelect("mux select (cached channel)", iterations, esp_timer_get_time() - start);
+}
+
+/**
+ * @brief Print the per-scan cost of an analog scan benchmark
+ */
+static void reportScan(const char* name, int samples, int scans, int64_t elapsedUs)
+{
+    ESP_LOGI(TAG, "%s: %d scans of %d channels (%d samples) in %" PRId64 " us, %.1f us/scan", name, scans,
+             SCAN_CHANNELS, samples, elapsedUs, (double)elapsedUs / scans);
+}
+
+/**
+ * @brief Read SCAN_CHANNELS channels the way HAL::analogReadMany does, enable once and walk the mux
+ */
+static int64_t scanOnePass(app::hal::CD74HC4067& mux, int samples, int scans)
+{
+    uint16_t val = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < scans; ++i)
+    {
+        (void)mux.configureRead();
+        (void)mux.enable();
+        for (int channel = 1; channel <= SCAN_CHANNELS; ++channel)
+        {
+            (void)mux.select(channel);
+            (void)mux.read(val, samples);
+        }
+        (void)mux.disable();
+    }
+    return esp_timer_get_time() - start;
+}
+
+void analogScan(app::hal::CD74HC4067& mux, int scans)
+{
+    uint16_t val = 0;
+
+    (void)mux.disable();
+
+    // what HAL::analogRead did per pin: select, enable, one conversion, disable and a log line
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < scans; ++i)
+    {
+        for (int channel = 1; channel <= SCAN_CHANNELS; ++channel)
+        {
+            (void)mux.select(channel);
+            (void)mux.enable();
+            (void)mux.read(val);
+            (void)mux.disable();
+            ESP_LOGI(TAG, "analogRead: pin=%d val=%d", channel, val);
+        }
+    }
+    int64_t legacyUs = esp_timer_get_time() - start;
+
+    int64_t singleUs = scanOnePass(mux, 1, scans);
+    int64_t medianUs = scanOnePass(mux, SCAN_SAMPLES, scans);
+
+    // report after all loops, the legacy log lines would bury the results
+    reportScan("analog scan (legacy, per pin with log)", 1, scans, legacyUs);
+    reportScan("analog scan (one pass)", 1, scans, singleUs);
+    reportScan("analog scan (one pass, median)", SCAN_SAMPLES, scans, medianUs);
+}
+
+/**
+ * @brief Print the per-value cost of a DAC write benchmark
+ */
+static void reportDac(const char* name, int iterations, int64_t elapsedUs)
+{
+    ESP_LOGI(TAG, "%s: %d values in %" PRId64 " us, %.1f us/value", name, iterations, elapsedUs,
+             (double)elapsedUs / iterations);
+}
+
+void dacWrite(app::hal::MCP4725& dac, int iterations)
+{
+    // ramp over the full range, one step per value
+    auto value = [](int i) { return (uint16_t)((i * 64) & 0x0FFF); };
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        (void)dac.write(value(i));
+    }
+    reportDac("dac write (3-byte command)", iterations, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; ++i)
+    {
+        (void)dac.writeFast(value(i));
+    }
+    reportDac("dac write (fast mode)", iterations, esp_timer_get_time() - start);
+
+    std::array<uint16_t, app::hal::MCP4725::MAX_SEQUENCE_LENGTH> ramp;
+    for (size_t i = 0; i < ramp.size(); ++i)
+    {
+        ramp[i] = value((int)i);
+    }
+
+    int written = 0;
+    start       = esp_timer_get_time();
+    while (written < iterations)
+    {
+        size_t count = std::min(ramp.size(), (size_t)(iterations - written));
+        if (dac.writeSequence(ramp.data(), count) != ESP_OK)
+        {
+            return;
+        }
+        written += (int)count;
+    }
+    reportDac("dac write (fast mode sequence)", iterations, esp_timer_get_time() - start);
+
+    (void)dac.writeFast(0);
+}
+
+void dacThroughput(const app::hal::MCP4725::Config_t& config, int iterations)
+{
+    static constexpr std::array<const char*, app::hal::MCP4725::BUS_MODE_CNT> MODE_NAMES = {"standard", "fast",
+                                                                                            "high-speed"};
+
+    std::array<uint16_t, app::hal::MCP4725::MAX_SEQUENCE_LENGTH> ramp;
+    for (size_t i = 0; i < ramp.size(); ++i)
+    {
+        ramp[i] = (uint16_t)((i * 128) & 0x0FFF);
+    }
+
+    for (int mode = 0; mode < app::hal::MCP4725::BUS_MODE_CNT; ++mode)
+    {
+        app::hal::MCP4725::Config_t modeConfig = config;
+        modeConfig.busMode                     = static_cast<app::hal::MCP4725::BusMode_t>(mode);
+        modeConfig.i2cFreqHz                   = 0;  // maximum of the mode
+
+        app::hal::MCP4725 dac;  // released at the end of the iteration, so the next mode can create the bus
+        esp_err_t         err = dac.init(modeConfig);
+        if (err != ESP_OK)
+        {
+            ESP_LOGI(TAG, "dac throughput (%s): %s", MODE_NAMES[mode], esp_err_to_name(err));
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < iterations; ++i)
+        {
+            (void)dac.writeFast(ramp[i % ramp.size()]);
+        }
+        int64_t singleUs = esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        for (int written = 0; written < iterations; written += (int)ramp.size())
+        {
+            (void)dac.writeSequence(ramp.data(), std::min(ramp.size(), (size_t)(iterations - written)));
+        }
+        int64_t sequenceUs = esp_timer_get_time() - start;
+
+        ESP_LOGI(TAG, "dac throughput (%s, %" PRIu32 " Hz): %.0f writes/s single, %.0f writes/s sequence",
+                 MODE_NAMES[mode], app::hal::MCP4725::BUS_MODE_MAX_FREQ_HZ[mode], 1e6 * iterations / singleUs,
+                 1e6 * iterations / sequenceUs);
+        (void)dac.writeFast(0);
+    }
+}
+
+/**
+ * @brief Print the pulse width error of a pulse timing benchmark
+ */
+static void reportWidth(const char* name, int64_t widthUs, int iterations, int64_t sumErrUs, int64_t maxErrUs)
+{
+    ESP_LOGI(TAG, "%s: %" PRId64 " us pulses, mean error %.1f us, max error %" PRId64 " us", name, widthUs,
+             (double)sumErrUs / iterations, maxErrUs);
+}
+
+void pulseWidth(app::hal::PulseEngine& engine, int64_t widthUs, int iterations)
+{
+    int64_t sumErr = 0;
+    int64_t maxErr = 0;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        int64_t start = esp_timer_get_time();
+        vTaskDelay(pdMS_TO_TICKS(widthUs / 1000));
+        int64_t err  = llabs(esp_timer_get_time() - start - widthUs);
+        sumErr      += err;
+        maxErr       = (err > maxErr) ? err : maxErr;
+    }
+    reportWidth("pulse width (vTaskDelay)", widthUs, iterations, sumErr, maxErr);
+
+    sumErr = 0;
+    maxErr = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        int64_t start = esp_timer_get_time();
+        if (engine.hold(widthUs) != ESP_OK)
+        {
+            return;
+        }
+        int64_t err  = llabs(esp_timer_get_time() - start - widthUs);
+        sumErr      += err;
+        maxErr       = (err > maxErr) ? err : maxErr;
+    }
+    reportWidth("pulse width (pulse engine)", widthUs, iterations, sumErr, maxErr);
+}
+
+}  // namespace bench
+}  // namespace app
@@ -0,0 +1,103 @@
+/**
+ * @file hal_bench.hpp
+ * @brief Microbenchmarks for the HAL drivers (CD74HC4067, MCP4725)
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#pragma once
+
+#include "cd74hc4067.hpp"
+#include "driver/gpio.h"
+#include "mcp4725.hpp"
+#include "pulse_engine.hpp"
+
+namespace app
+{
+namespace bench
+{
+
+/**
+ * @brief Measure the cost of switching the Signal pin the way CD74HC4067 used to do it
+ *
+ * Every read creates an ADC oneshot unit and every write deletes it again (reference for the current driver).
+ * Must run before the CD74HC4067 is initialised, since the driver keeps the ADC unit for its lifetime.
+ *
+ * @param signal Signal pin of the multiplexer
+ * @param enable Enable pin of the multiplexer (held high during the benchmark)
+ * @param iterations Number of read/write cycles (2 switches per cycle)
+ */
+void signalSwitchLegacy(gpio_num_t signal, gpio_num_t enable, int iterations);
+
+/**
+ * @brief Measure the cost of switching the Signal pin between ADC input and GPIO output
+ *
+ * Alternates CD74HC4067::read and CD74HC4067::write with the multiplexer disabled, so nothing is driven.
+ *
+ * @param mux Initialised multiplexer
+ * @param iterations Number of read/write cycles (2 switches per cycle)
+ */
+void signalSwitch(app::hal::CD74HC4067& mux, int iterations);
+
+/**
+ * @brief Measure the latency of selecting a multiplexer channel
+ *
+ * Alternates between channels 0 and 15, so that all four select lines change on every select, with
+ * one gpio_set_level per line (reference) and with CD74HC4067::select (set/clear register writes),
+ * then re-selects the same channel (cached, no register access). The multiplexer stays disabled.
+ *
+ * @param mux Initialised multiplexer
+ * @param config Configuration the multiplexer was initialised with
+ * @param iterations Number of selects per method
+ */
+void selectLatency(app::hal::CD74HC4067& mux, const app::hal::CD74HC4067::Config_t& config, int iterations);
+
+/**
+ * @brief Measure the cost of reading the refresh segments of a display
+ *
+ * Reads channels 1-15 per pin like HAL::analogRead used to (select, enable, read, disable, log line) and
+ * in one pass like HAL::analogReadMany (mux enabled once), with a single sample and with median oversampling.
+ * The multiplexer only connects the high impedance ADC input, so nothing is driven.
+ *
+ * @param mux Initialised multiplexer
+ * @param scans Number of scans per method
+ */
+void analogScan(app::hal::CD74HC4067& mux, int scans);
+
+/**
+ * @brief Measure the cost of a DAC update with the three MCP4725 write paths
+ *
+ * Writes a ramp with write() (3-byte command), writeFast() (2-byte Fast Mode) and writeSequence()
+ * (back-to-back Fast Mode writes in one transaction) and logs the time per value.
+ *
+ * @param dac Initialised DAC
+ * @param iterations Number of values per write path
+ */
+void dacWrite(app::hal::MCP4725& dac, int iterations);
+
+/**
+ * @brief Measure the DAC write throughput for every MCP4725 bus mode
+ *
+ * Creates a DAC on the given bus for each MCP4725::BusMode_t at the maximum frequency of the mode and logs
+ * the achieved writes per second for single Fast Mode writes and Fast Mode sequences.
+ * Must run while no other MCP4725 uses the bus.
+ *
+ * @param config DAC configuration, busMode and i2cFreqHz are overridden
+ * @param iterations Number of values per measurement
+ */
+void dacThroughput(const app::hal::MCP4725::Config_t& config, int iterations);
+
+/**
+ * @brief Measure the pulse width error of vTaskDelay and the pulse engine
+ *
+ * Times pulses of the given width (multiplexer disabled, so nothing is driven) and logs the mean and
+ * maximum deviation from the requested width for both timing methods.
+ *
+ * @param engine Initialised pulse engine
+ * @param widthUs Requested pulse width (microseconds)
+ * @param iterations Number of pulses per method
+ */
+void pulseWidth(app::hal::PulseEngine& engine, int64_t widthUs, int iterations);
+
+}  // namespace bench
+}  // namespace app
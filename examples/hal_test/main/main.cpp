@@ -17,6 +17,7 @@
 #include "cd74hc4067.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "hal_bench.hpp"
 #include "mcp4725.hpp"
 
 /** @brief Maximum DAC value for 12-bit resolution (4096) */
@@ -37,7 +38,15 @@ static const char* TAG = "hal_test";
  *
  * @note Hardware Configuration:
  *       - CD74HC4067: GPIOs 9,11,13,14 (select) + 10 (signal) + 12 (enable)
- *       - MCP4725: I2C (SDA: GPIO38, SCL: GPIO41, Address: 0x60, 100kHz)
+ *       - MCP4725: I2C (SDA: GPIO38, SCL: GPIO41, Address: 0x60, 400kHz Fast Mode)
+ *
+ * @note Benchmarks (CONFIG_HAL_TEST_BENCHMARK):
+ *       - Signal pin read/write switching cost, legacy (ADC unit per read) vs. persistent ADC unit
+ *       - Channel select latency, gpio_set_level per line vs. set/clear register writes vs. cached channel
+ *       - Cost of reading 15 channels, per pin with log line vs. one pass (single sample and median)
+ *       - Pulse width error of vTaskDelay vs. the esp_timer pulse engine
+ *       - DAC update cost of the 3-byte write, Fast Mode write and Fast Mode sequence
+ *       - DAC writes per second for every I2C bus mode
  *
  * @note Test Pattern:
  *       - Channel 1: ADC reading every cycle
@@ -52,25 +61,56 @@ extern "C" void app_main(void)
     app::hal::CD74HC4067 mux;  ///< 16-channel analog multiplexer
     app::hal::MCP4725    dac;  ///< 12-bit I2C DAC for common electrode
 
+#ifdef CONFIG_HAL_TEST_BENCHMARK
+    // reference measurement, needs the ADC unit to be free
+    app::bench::signalSwitchLegacy(GPIO_NUM_10, GPIO_NUM_12, CONFIG_HAL_TEST_BENCHMARK_ITERATIONS);
+#endif
+
     // Configure multiplexer with ESP32-S3-Box3 GPIO assignments
-    ESP_ERROR_CHECK(mux.init({
+    static constexpr app::hal::CD74HC4067::Config_t muxConfig = {
         .s0     = GPIO_NUM_11,  ///< Select bit 0
         .s1     = GPIO_NUM_9,   ///< Select bit 1
         .s2     = GPIO_NUM_14,  ///< Select bit 2
         .s3     = GPIO_NUM_13,  ///< Select bit 3
         .signal = GPIO_NUM_10,  ///< Analog signal pin
         .enable = GPIO_NUM_12   ///< Enable/disable pin
-    }));
+    };
+    static_assert(app::hal::CD74HC4067::selectLut(muxConfig)[0x5] == ((1ull << GPIO_NUM_11) | (1ull << GPIO_NUM_14)),
+                  "select lookup table is built at compile time");
+    ESP_ERROR_CHECK(mux.init(muxConfig));
+
+#ifdef CONFIG_HAL_TEST_BENCHMARK
+    app::bench::signalSwitch(mux, CONFIG_HAL_TEST_BENCHMARK_ITERATIONS);
+    app::bench::selectLatency(mux, muxConfig, CONFIG_HAL_TEST_BENCHMARK_ITERATIONS);
+    app::bench::analogScan(mux, 20);  // the per-pin reference logs every read
+
+    // the timer callback ends the pulse the way HAL does
+    app::hal::PulseEngine engine;
+    ESP_ERROR_CHECK(engine.init([](void* arg) { (void)static_cast<app::hal::CD74HC4067*>(arg)->disable(); }, &mux));
+    app::bench::pulseWidth(engine, 50000, 20);  // refresh pulse width
+#endif
 
     // Configure DAC with I2C parameters
-    ESP_ERROR_CHECK(dac.init({
-        .busHandle  = nullptr,      ///< Use BSP I2C bus
-        .i2cPort    = 0,            ///< I2C port 0
-        .i2cAddr    = 0x60,         ///< MCP4725 default address
-        .i2cSdaGpio = GPIO_NUM_38,  ///< I2C data line
-        .i2cSclGpio = GPIO_NUM_41,  ///< I2C clock line
-        .i2cFreqHz  = 100000        ///< 100kHz I2C frequency
-    }));
+    const app::hal::MCP4725::Config_t dacConfig = {
+        .busHandle  = nullptr,                           ///< Use BSP I2C bus
+        .i2cPort    = 0,                                 ///< I2C port 0
+        .i2cAddr    = 0x60,                              ///< MCP4725 default address
+        .i2cSdaGpio = GPIO_NUM_38,                       ///< I2C data line
+        .i2cSclGpio = GPIO_NUM_41,                       ///< I2C clock line
+        .i2cFreqHz  = 400000,                            ///< 400kHz I2C frequency
+        .busMode    = app::hal::MCP4725::BUS_MODE_FAST,  ///< Fast Mode
+    };
+
+#ifdef CONFIG_HAL_TEST_BENCHMARK
+    // creates its own DAC per bus mode, needs the bus to be free
+    app::bench::dacThroughput(dacConfig, CONFIG_HAL_TEST_BENCHMARK_ITERATIONS);
+#endif
+
+    ESP_ERROR_CHECK(dac.init(dacConfig));
+
+#ifdef CONFIG_HAL_TEST_BENCHMARK
+    app::bench::dacWrite(dac, CONFIG_HAL_TEST_BENCHMARK_ITERATIONS);
+#endif
 
     // Test loop variables
     bool     writeVal = true;  ///< Alternating digital output value
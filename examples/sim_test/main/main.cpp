@@ -0,0 +1,265 @@
+/**
+ * @file main.cpp
+ * @brief Off-target simulation of the ECD driving modes
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ *
+ * This application runs the ECD drivers against SimHAL (simulated multiplexer, DAC and
+ * electrochromic segments) on the ESP-IDF linux target. It drives a signed number display
+ * through a counting animation in passive, delta passive, interleaved, active and adaptive active mode and reports
+ * the refresh retries and the (virtual) time spent driving. Active driving with segment health tracking also runs
+ * with one worn segment.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "disp_signed_number.hpp"
+#include "esp_log.h"
+#include "sim_hal.hpp"
+
+/** @brief Log tag for ESP-IDF logging system */
+static const char* TAG = "sim_test";
+
+namespace
+{
+/** @brief Count heap allocations (operator new) while set */
+std::atomic<bool> s_countAllocations {false};
+
+/** @brief Heap allocations counted since the last reset */
+std::atomic<uint32_t> s_allocations {0};
+}  // namespace
+
+/**
+ * @brief Global allocation hook, the drive path must not allocate during update()
+ */
+void* operator new(std::size_t size)
+{
+    if (s_countAllocations.load())
+    {
+        s_allocations++;
+    }
+    void* ptr = std::malloc(size != 0 ? size : 1);
+    if (ptr == nullptr)
+    {
+        abort();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+/** @brief Counter transition rate, same as AnimBase::DEFAULT_TRANSITION_RATE_MS */
+constexpr int TRANSITION_RATE_MS = 5000;
+
+/** @brief Segment aged by the worn rows */
+constexpr int WORN_SEGMENT = 8;
+
+/** @brief Wear factor of WORN_SEGMENT in the worn rows */
+constexpr float WORN_FACTOR = 8.0f;
+
+/**
+ * @brief Simulation results of one driving mode
+ */
+struct SimResult_t
+{
+    int      updates;         ///< Number of update() calls
+    int64_t  driveTimeUs;     ///< Virtual time spent in update()
+    int64_t  maxUpdateUs;     ///< Longest update() in virtual time
+    int64_t  p50Us;           ///< Median update() time of the last DriveStats_t::LATENCY_WINDOW updates
+    int64_t  p99Us;           ///< 99th percentile update() time of the last DriveStats_t::LATENCY_WINDOW updates
+    int      refreshRetries;  ///< Sum of refresh iterations
+    int      maxRetries;      ///< Most refresh iterations in a single update()
+    uint32_t timeouts;        ///< Updates whose refresh loop gave up
+    uint32_t digitalWrites;   ///< HAL digitalWrite calls
+    uint32_t dacWrites;       ///< DAC writes
+    uint32_t analogReads;     ///< Channels read by the HAL
+    uint32_t allocations;     ///< Heap allocations during update()
+    double   wallTimeMs;      ///< Host time spent in update()
+};
+
+/**
+ * @brief Run the counting animation on a signed number display
+ * @param mode Driving mode flags (activeDriving, adaptiveRefresh, segmentHealth, predictiveRefresh, deltaDriving,
+ *             interleavedDriving), the remaining fields are set here
+ * @param wear Wear factor of segment WORN_SEGMENT (1=new, see SimHAL::wear)
+ * @param paused The counter stops after its first value, every update only refreshes (Anim PAUSED)
+ * @return Simulation results
+ */
+SimResult_t simulate(const ynv::app::AppConfig_t& mode, float wear = 1.0f, bool paused = false)
+{
+    ynv::app::AppConfig_t appConfig = mode;
+    appConfig.maintenanceIntervalMs = CONFIG_SIM_TEST_MAINTENANCE_MS;
+    appConfig.subPulseMs            = CONFIG_SIM_TEST_SUB_PULSE_MS;
+    appConfig.analogResolution      = 12;
+
+    app::hal::SimHAL hal;
+    hal.init(&appConfig);
+
+    ynv::ecd::DispSignedNumber display(&ynv::ecd::DispSignedNumber::PINS, &appConfig);
+    display.init();
+    hal.wear(ynv::ecd::DispSignedNumber::PINS[WORN_SEGMENT], wear);
+
+    SimResult_t result = {};
+    int         counter {0};
+    s_allocations.store(0);
+    const int   transitionTicks {std::max(1, TRANSITION_RATE_MS / CONFIG_SIM_TEST_TICK_MS)};
+    std::chrono::duration<double, std::milli> wall {0};
+
+    for (int cycle = 0; cycle < CONFIG_SIM_TEST_CYCLES; ++cycle)
+    {
+        // the animation changes the digits every TRANSITION_RATE_MS and only refreshes in between
+        if (cycle % transitionTicks == 0 && (!paused || cycle == 0))
+        {
+            counter = (counter + 1) % 100;
+            display.show(counter / 10, counter % 10, false);
+        }
+
+        int64_t start     = hal.micros();
+        auto    wallStart = std::chrono::steady_clock::now();
+        s_countAllocations.store(true);
+        display.update();
+        s_countAllocations.store(false);
+        wall += std::chrono::steady_clock::now() - wallStart;
+        int64_t elapsed = hal.micros() - start;
+
+        result.updates++;
+        result.driveTimeUs += elapsed;
+        result.maxUpdateUs = std::max(result.maxUpdateUs, elapsed);
+
+        // polled like a monitoring task would, the percentiles cover the last LATENCY_WINDOW updates
+        ynv::ecd::DriveStats_t stats;
+        display.getDriveStats(stats);
+        result.refreshRetries += stats.refreshRetries;
+        result.maxRetries = std::max(result.maxRetries, stats.refreshRetries);
+        result.p50Us      = stats.p50Us;
+        result.p99Us      = stats.p99Us;
+        result.timeouts   = stats.timeouts;
+
+        hal.advance((int64_t)CONFIG_SIM_TEST_TICK_MS * 1000);
+    }
+
+    result.wallTimeMs    = wall.count();
+    result.digitalWrites = hal.getStats().digitalWrites;
+    result.dacWrites     = hal.getStats().dacWrites;
+    result.analogReads   = hal.getStats().analogReads;
+    result.allocations   = s_allocations.load();
+    return result;
+}
+
+/**
+ * @brief Print the HAL timing of a color and a bleach pulse with blocking and overlapped DAC writes
+ */
+void traceDacOverlap()
+{
+    for (bool asyncDac : {false, true})
+    {
+        ynv::app::AppConfig_t appConfig = {};
+        appConfig.analogResolution      = 12;
+
+        app::hal::SimHAL::Config_t config = app::hal::SimHAL::DEFAULT_CONFIG;
+        config.asyncDac                   = asyncDac;
+
+        app::hal::SimHAL hal;
+        hal.init(&appConfig, config);
+
+        const ynv::driver::Pulse_t pulses[] = {
+            {.pin = 1, .high = true, .durationUs = 1000, .common = appConfig.highPinVoltage / 2},
+            {.pin = 2, .high = false, .durationUs = 1000, .common = appConfig.maxSegmentVoltage / 2},
+        };
+
+        printf("\nDAC write %s mux setup:\n", asyncDac ? "overlapped with" : "before");
+        hal.startTrace();
+        hal.pulse(pulses, sizeof(pulses) / sizeof(pulses[0]));
+        hal.printTrace();
+    }
+}
+
+/**
+ * @brief Print simulation results
+ */
+void report(const char* mode, const SimResult_t& r)
+{
+    printf("%-11s | %7d | %10.1f | %10.1f | %6.1f | %6.1f | %7d | %5d | %4" PRIu32 " | %8" PRIu32 " | %8" PRIu32
+           " | %8" PRIu32 " | %9.0f\n",
+           mode, r.updates, (double)r.driveTimeUs / 1000 / r.updates, (double)r.maxUpdateUs / 1000,
+           (double)r.p50Us / 1000, (double)r.p99Us / 1000, r.refreshRetries, r.maxRetries, r.timeouts, r.digitalWrites,
+           r.dacWrites, r.analogReads, r.updates / (r.wallTimeMs / 1000));
+}
+}  // namespace
+
+/**
+ * @brief Main application entry point for the simulation
+ *
+ * Simulates CONFIG_SIM_TEST_CYCLES update cycles, CONFIG_SIM_TEST_TICK_MS apart, for
+ * passive, delta passive, interleaved, active, adaptive active and segment health driving and prints one result row
+ * per mode. The worn rows repeat active driving without and with segment health, with WORN_SEGMENT aged by
+ * WORN_FACTOR.
+ * Exits with EXIT_FAILURE if any update() allocated heap memory. With CONFIG_SIM_TEST_TRACE the HAL timing of
+ * blocking and overlapped DAC writes is printed afterwards.
+ */
+extern "C" void app_main(void)
+{
+    ESP_LOGI(TAG, "Simulating %d cycles per driving mode", CONFIG_SIM_TEST_CYCLES);
+
+    SimResult_t passive     = simulate({});
+    SimResult_t delta       = simulate({.deltaDriving = true});
+    SimResult_t interleaved = simulate({.interleavedDriving = true});
+    SimResult_t active      = simulate({.activeDriving = true});
+    SimResult_t adaptive    = simulate({.activeDriving = true, .adaptiveRefresh = true});
+    SimResult_t health      = simulate({.activeDriving = true, .segmentHealth = true});
+    SimResult_t predictive  = simulate({.activeDriving = true, .predictiveRefresh = true});
+    SimResult_t hysteresis  = simulate({.activeDriving = true, .hysteresisRefresh = true});
+    SimResult_t wornActive  = simulate({.activeDriving = true}, WORN_FACTOR);
+    SimResult_t wornHealth  = simulate({.activeDriving = true, .segmentHealth = true}, WORN_FACTOR);
+    SimResult_t pausedAct   = simulate({.activeDriving = true}, 1.0f, true);
+    SimResult_t pausedPred  = simulate({.activeDriving = true, .predictiveRefresh = true}, 1.0f, true);
+    SimResult_t pausedHyst  = simulate({.activeDriving = true, .hysteresisRefresh = true}, 1.0f, true);
+    SimResult_t pausedBoth  =
+        simulate({.activeDriving = true, .predictiveRefresh = true, .hysteresisRefresh = true}, 1.0f, true);
+
+    printf("mode        | updates | avg ms/upd | max ms/upd | p50 ms | p99 ms | retries | max   | tmo  | writes   | dac      "
+           "| reads    | upd/s host\n");
+    report("passive", passive);
+    report("delta", delta);
+    report("interleaved", interleaved);
+    report("active", active);
+    report("adaptive", adaptive);
+    report("health", health);
+    report("predictive", predictive);
+    report("hysteresis", hysteresis);
+    report("worn active", wornActive);
+    report("worn health", wornHealth);
+    report("paused act", pausedAct);
+    report("paused pred", pausedPred);
+    report("paused hyst", pausedHyst);
+    report("paused both", pausedBoth);
+
+    // the per-frame path (set, update, drive) must run without heap allocations
+    uint32_t allocations = passive.allocations + delta.allocations + interleaved.allocations + active.allocations +
+                           adaptive.allocations + health.allocations + predictive.allocations +
+                           wornActive.allocations + wornHealth.allocations + pausedAct.allocations +
+                           pausedPred.allocations + hysteresis.allocations + pausedHyst.allocations +
+                           pausedBoth.allocations;
+    if (allocations != 0)
+    {
+        ESP_LOGE(TAG, "%" PRIu32 " heap allocations during update()", allocations);
+        exit(EXIT_FAILURE);
+    }
+    ESP_LOGI(TAG, "No heap allocations during update()");
+
+#ifdef CONFIG_SIM_TEST_TRACE
+    traceDacOverlap();
+#endif
+
+    exit(EXIT_SUCCESS);
+}
@@ -4,10 +4,12 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
 #include "esp_timer.h"
+#include "ynv_event_bus.hpp"
 
 namespace ynv
 {
@@ -35,13 +37,35 @@ class AnimBase
         COMPLETED  ///< Animation finished normally
     };
 
-    AnimBase() : m_state(State_t::IDLE), m_stateChangeCallback(nullptr) { }
+    /** @brief Default time between two transitions (ms) */
+    static constexpr uint32_t DEFAULT_TRANSITION_RATE_MS = 5000;
+
+    /** @brief Returned by step() when the animation has nothing to do until the next control event */
+    static constexpr int64_t NO_DEADLINE = INT64_MAX;
+
+    AnimBase()
+        : m_state(State_t::IDLE),
+          m_eventSource(0),
+          m_asyncUpdate(false),
+          m_transitionRateMs(DEFAULT_TRANSITION_RATE_MS),
+          m_refreshIntervalMs(0)
+    {
+    }
     virtual ~AnimBase() = default;
 
     /**
-     * @brief Update animation state (called in main loop)
+     * @brief Advance the animation to the given time
+     * @param nowUs Current time (esp_timer time base)
+     * @return Time the animation wants the next step (esp_timer time base), NO_DEADLINE if none
+     *
+     * Called by AnimScheduler at the returned deadline and after every control event.
+     */
+    virtual int64_t step(int64_t nowUs) = 0;
+
+    /**
+     * @brief Update animation state (polling, called in main loop)
      */
-    virtual void update() = 0;
+    void update() { (void)step(esp_timer_get_time()); }
 
     /**
      * @brief Start the animation from idle state
@@ -116,15 +140,11 @@ class AnimBase
      */
     State_t getState() const { return m_state; }
 
-    /** @brief State change callback function type */
-    // TODO: C++-style using
-    typedef void (*StateChangeCallback_f)(State_t);
-
     /**
-     * @brief Register callback for state changes
-     * @param cb Callback function
+     * @brief Set the source of the events this animation publishes (EventBus, EVENT_ANIM_*)
+     * @param source Identifier for the subscribers, e.g. the display index or the engine lane
      */
-    void registerStateChangeCallback(StateChangeCallback_f cb) { m_stateChangeCallback = cb; }
+    void setEventSource(uint8_t source) { m_eventSource = source; }
 
     /**
      * @brief Check if animation is currently running
@@ -132,24 +152,48 @@ class AnimBase
      */
     bool isRunning() { return m_state == State_t::RUNNING; }
 
+    /**
+     * @brief Drive the display in the background (ECDBase::updateAsync) instead of blocking in update()
+     * @param async true to use asynchronous display updates
+     */
+    void setAsyncUpdate(bool async) { m_asyncUpdate = async; }
+
+    /**
+     * @brief Set the time between two transitions, takes effect from the next transition
+     * @param rateMs Transition rate (ms, at least 1)
+     */
+    void setTransitionRate(uint32_t rateMs) { m_transitionRateMs = std::max<uint32_t>(rateMs, 1); }
+
+    /**
+     * @brief Get the time between two transitions
+     * @return Transition rate (ms)
+     */
+    uint32_t getTransitionRate() const { return m_transitionRateMs; }
+
+    /**
+     * @brief Update the display between transitions and while paused, so the driver can refresh the segments
+     * @param intervalMs Refresh interval (ms), 0 to update the display on transitions and state changes only
+     */
+    void setRefreshInterval(uint32_t intervalMs) { m_refreshIntervalMs = intervalMs; }
+
    protected:
-    State_t               m_state;                ///< Current animation state
-    StateChangeCallback_f m_stateChangeCallback;  ///< State change callback
+    State_t  m_state;              ///< Current animation state
+    uint8_t  m_eventSource;        ///< Source of the published events
+    bool     m_asyncUpdate;        ///< Use asynchronous display updates
+    uint32_t m_transitionRateMs;   ///< Time between two transitions (ms)
+    uint32_t m_refreshIntervalMs;  ///< Display update interval without transition (ms), 0=none
 
     /** @brief Mark animation as completed */
     void complete() { setState(State_t::COMPLETED); }
 
     /**
-     * @brief Set new state and trigger callback
+     * @brief Set new state and publish it (EVENT_ANIM_STATE), subscribers read it in their own task
      * @param state New state to set
      */
     void setState(State_t state)
     {
         m_state = state;
-        if (m_stateChangeCallback)
-        {
-            m_stateChangeCallback(m_state);
-        }
+        ynv::driver::EventBus::getInstance().publish(ynv::driver::EVENT_ANIM_STATE, m_eventSource, (int32_t)state);
     }
 };
 
@@ -161,52 +205,56 @@ template <typename DisplayT>
 class Anim : public AnimBase
 {
    public:
-    /** @brief Animation transition rate in milliseconds */
-    // TODO: Make configurable per animation
-    static constexpr int TRANSITION_RATE_MS = 5000;
-
-    explicit Anim(std::shared_ptr<DisplayT> display) : m_display(display) { }
+    explicit Anim(std::shared_ptr<DisplayT> display) : m_display(display), m_transitionUs(0), m_transitions(0) { }
     virtual ~Anim() = default;
 
     /**
-     * @brief Update animation state in main loop
+     * @brief Advance the animation to the given time
+     * @param nowUs Current time (esp_timer time base)
+     * @return Time of the next transition or display refresh, NO_DEADLINE if idle
+     *
+     * Transitions stay on the grid set by the start of the animation, a late step does not delay the
+     * following transitions. Transitions missed entirely (e.g. by a long blocking update) are skipped.
      */
-    void update() override
+    int64_t step(int64_t nowUs) override
     {
-        uint32_t now = esp_timer_get_time() / 1000;  // Convert to milliseconds
-
         switch (m_state)
         {
             case State_t::READY:
                 setState(State_t::RUNNING);
-                m_display->set();
-                m_display->update();
-                m_lastUpdate = now;
+                m_transitions = 0;
+                begin();
+                updateDisplay();
+                m_transitionUs = nowUs + holdUs();
                 break;
 
             case State_t::RUNNING:
-                if ((now - m_lastUpdate) >= TRANSITION_RATE_MS)
+                if (nowUs >= m_transitionUs)
                 {
                     transition();
-                    m_lastUpdate = now;
+                    ynv::driver::EventBus::getInstance().publish(ynv::driver::EVENT_ANIM_TRANSITION, m_eventSource,
+                                                                 (int32_t)++m_transitions);
+                    int64_t rateUs = holdUs();
+                    m_transitionUs += ((nowUs - m_transitionUs) / rateUs + 1) * rateUs;
                 }
-                m_display->update();
+                updateDisplay();
                 break;
 
             case State_t::COMPLETED:
             case State_t::ABORTED:
                 setState(State_t::IDLE);
                 m_display->reset();
-                m_display->update();
+                updateDisplay();
                 break;
 
             case State_t::PAUSED:
-                m_display->update();
+                updateDisplay();
                 break;
 
             default:
                 break;
         }
+        return nextDeadline(nowUs);
     }
 
    protected:
@@ -217,8 +265,58 @@ class Anim : public AnimBase
      */
     virtual void transition() = 0;
 
+    /** @brief Show the first state of the animation, all segments colored by default */
+    virtual void begin() { m_display->set(); }
+
+    /**
+     * @brief Time from the transition just made (or the start) to the next one
+     * @return Hold time (ms), the transition rate by default
+     */
+    virtual uint32_t holdMs() const { return m_transitionRateMs; }
+
+    /** @brief Apply pending display changes, blocking or in the background */
+    void updateDisplay()
+    {
+        if (m_asyncUpdate)
+        {
+            (void)m_display->updateAsync();
+        }
+        else
+        {
+            m_display->update();
+        }
+    }
+
    private:
-    unsigned long m_lastUpdate = 0;  ///< Last update timestamp in milliseconds
+    int64_t  m_transitionUs;  ///< Time of the next transition (esp_timer time base)
+    uint32_t m_transitions;   ///< Transitions since the start
+
+    /** @brief Hold time of the current state, at least 1 ms */
+    int64_t holdUs() const { return (int64_t)std::max<uint32_t>(holdMs(), 1) * 1000; }
+
+    /**
+     * @brief Deadline of the next step in the current state
+     * @param nowUs Current time (esp_timer time base)
+     * @return Next step time, NO_DEADLINE if idle
+     */
+    int64_t nextDeadline(int64_t nowUs) const
+    {
+        int64_t refreshUs = (m_refreshIntervalMs > 0) ? nowUs + (int64_t)m_refreshIntervalMs * 1000 : NO_DEADLINE;
+
+        switch (m_state)
+        {
+            case State_t::READY:
+            case State_t::COMPLETED:
+            case State_t::ABORTED:
+                return nowUs;  // pending state change, step again right away
+            case State_t::RUNNING:
+                return std::min(m_transitionUs, refreshUs);
+            case State_t::PAUSED:
+                return refreshUs;
+            default:
+                return NO_DEADLINE;
+        }
+    }
 };
 
 }  // namespace anim
@@ -23,7 +23,7 @@ class AnimToggle : public Anim<ynv::ecd::ECDBase>
    protected:
     void transition() override
     {
-        m_display->toggle();  // Toggle the display state
+        m_display->toggleTarget();  // Toggle the last requested state, also while an async update runs
     }
 };
 
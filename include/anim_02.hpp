@@ -7,29 +7,26 @@
 
 #pragma once
 
-#include "anim.hpp"
-#include "disp_decimal_number.hpp"
+#include "anim_timeline.hpp"
+#include "disp_signed_number.hpp"
 
 namespace ynv
 {
 namespace anim
 {
 
-class Anim15SegSignedPositiveCounterUp : public Anim<ynv::ecd::DispSignedNumber>
+class Anim15SegSignedPositiveCounterUp : public AnimCounter<ynv::ecd::DispSignedNumber>
 {
    public:
     explicit Anim15SegSignedPositiveCounterUp(std::shared_ptr<ynv::ecd::DispSignedNumber> display)
-        : Anim<ynv::ecd::DispSignedNumber>(display)
+        : AnimCounter<ynv::ecd::DispSignedNumber>(display, Timeline(FRAMES))
     {
     }
 
-   protected:
-    void transition() override
-    {
-        static int counter = 0;
-        counter            = (counter + 1) % 100;            // Increment counter and wrap around at 100
-        m_display->show(counter / 10, counter % 10, false);  // Update display with new values
-    }
+   private:
+    /** @brief 01, 02, .., 99, 00 without minus, one per transition */
+    static constexpr auto FRAMES = makeFrames<100>(
+        [](size_t i) { return ynv::ecd::DispSignedNumber::showMask((i + 1) % 100 / 10, (i + 1) % 10, false); });
 };
 
 }  // namespace anim
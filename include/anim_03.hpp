@@ -7,32 +7,26 @@
 
 #pragma once
 
-#include "anim.hpp"
-#include "disp_decimal_number.hpp"
+#include "anim_timeline.hpp"
+#include "disp_signed_number.hpp"
 
 namespace ynv
 {
 namespace anim
 {
 
-class Anim15SegSignedPositiveCounterDown : public Anim<ynv::ecd::DispSignedNumber>
+class Anim15SegSignedPositiveCounterDown : public AnimCounter<ynv::ecd::DispSignedNumber>
 {
    public:
     explicit Anim15SegSignedPositiveCounterDown(std::shared_ptr<ynv::ecd::DispSignedNumber> display)
-        : Anim<ynv::ecd::DispSignedNumber>(display)
+        : AnimCounter<ynv::ecd::DispSignedNumber>(display, Timeline(FRAMES))
     {
     }
 
-   protected:
-    void transition() override
-    {
-        static int counter = 99;
-        m_display->show(counter / 10, counter % 10, false);  // Update display with new values
-        if (--counter == 0)
-        {
-            counter = 99;
-        }
-    }
+   private:
+    /** @brief 99, 98, .., 01 without minus, one per transition */
+    static constexpr auto FRAMES = makeFrames<99>(
+        [](size_t i) { return ynv::ecd::DispSignedNumber::showMask((99 - i) / 10, (99 - i) % 10, false); });
 };
 
 }  // namespace anim
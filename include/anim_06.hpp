@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include "anim.hpp"
+#include "anim_timeline.hpp"
 #include "disp_decimal_number.hpp"
 
 namespace ynv
@@ -15,21 +15,18 @@ namespace ynv
 namespace anim
 {
 
-class Anim15SegDecimalCounterUp : public Anim<ynv::ecd::DispDecimalNumber>
+class Anim15SegDecimalCounterUp : public AnimCounter<ynv::ecd::DispDecimalNumber>
 {
    public:
     explicit Anim15SegDecimalCounterUp(std::shared_ptr<ynv::ecd::DispDecimalNumber> display)
-        : Anim<ynv::ecd::DispDecimalNumber>(display)
+        : AnimCounter<ynv::ecd::DispDecimalNumber>(display, Timeline(FRAMES))
     {
     }
 
-   protected:
-    void transition() override
-    {
-        static int counter = 0;
-        counter            = (counter + 1) % 100;     // Increment counter and wrap around at 100
-        m_display->show(counter / 10, counter % 10);  // Update display with new values
-    }
+   private:
+    /** @brief 01, 02, .., 99, 00, one per transition */
+    static constexpr auto FRAMES = makeFrames<100>(
+        [](size_t i) { return ynv::ecd::DispDecimalNumber::showMask((i + 1) % 100 / 10, (i + 1) % 10); });
 };
 
 }  // namespace anim
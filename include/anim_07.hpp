@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include "anim.hpp"
+#include "anim_timeline.hpp"
 #include "disp_decimal_number.hpp"
 
 namespace ynv
@@ -15,25 +15,18 @@ namespace ynv
 namespace anim
 {
 
-class Anim15SegDecimalCounterDown : public Anim<ynv::ecd::DispDecimalNumber>
+class Anim15SegDecimalCounterDown : public AnimCounter<ynv::ecd::DispDecimalNumber>
 {
    public:
     explicit Anim15SegDecimalCounterDown(std::shared_ptr<ynv::ecd::DispDecimalNumber> display)
-        : Anim<ynv::ecd::DispDecimalNumber>(display)
+        : AnimCounter<ynv::ecd::DispDecimalNumber>(display, Timeline(FRAMES))
     {
     }
 
-   protected:
-    void transition() override
-    {
-        static int counter = 99;
-
-        m_display->show(counter / 10, counter % 10);  // Update display with new values
-        if (--counter == 0)
-        {
-            counter = 99;
-        }
-    }
+   private:
+    /** @brief 99, 98, .., 01, one per transition */
+    static constexpr auto FRAMES = makeFrames<99>(
+        [](size_t i) { return ynv::ecd::DispDecimalNumber::showMask((99 - i) / 10, (99 - i) % 10); });
 };
 
 }  // namespace anim
@@ -26,7 +26,7 @@ class Anim1SegOn : public Anim<ynv::ecd::DispSingleSegment>
    protected:
     void transition() override
     {
-        m_display->toggle();  // Toggle the display state
+        m_display->toggleTarget();  // Toggle the last requested state, also while an async update runs
     }
 };
 
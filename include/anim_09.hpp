@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include "anim.hpp"
+#include "anim_timeline.hpp"
 #include "disp_dot_number.hpp"
 
 namespace ynv
@@ -15,21 +15,18 @@ namespace ynv
 namespace anim
 {
 
-class Anim7SegNumCounterUp : public Anim<ynv::ecd::DispDotNumber>
+class Anim7SegNumCounterUp : public AnimCounter<ynv::ecd::DispDotNumber>
 {
    public:
     explicit Anim7SegNumCounterUp(std::shared_ptr<ynv::ecd::DispDotNumber> display)
-        : Anim<ynv::ecd::DispDotNumber>(display)
+        : AnimCounter<ynv::ecd::DispDotNumber>(display, Timeline(FRAMES))
     {
     }
 
-   protected:
-    void transition() override
-    {
-        static int number = 0;                  // Initialize number to 0
-        number            = (number + 1) % 10;  // Increment number and wrap around at 10
-        m_display->show(number);
-    }
+   private:
+    /** @brief 1, 2, .., 9, 0, one per transition */
+    static constexpr auto FRAMES = makeFrames<10>(
+        [](size_t i) { return ynv::ecd::DispDotNumber::showMask((i + 1) % 10); });
 };
 
 }  // namespace anim
@@ -0,0 +1,183 @@
+/**
+ * @file anim_engine.hpp
+ * @brief Concurrent animations on several displays sharing one multiplexer and DAC
+ */
+#pragma once
+
+#include <array>
+
+#include "anim.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "ynv_hal_batch.hpp"
+
+namespace ynv
+{
+namespace anim
+{
+
+/**
+ * @brief Singleton engine that runs independent animations on several displays at once
+ *
+ * Every animation runs in a lane with its own task, each lane drives its own display. A dispatcher
+ * task keeps the deadlines of all lanes (AnimBase::step) and wakes the lanes that are due together.
+ * The displays are driven through a BatchHAL: the dispatcher attaches every lane it wakes, so the
+ * reads and pulses of lanes stepping together are merged into shared scans and pulse queues.
+ *
+ * The displays must be initialized with an AppConfig_t whose hal is the BatchHAL, use disjoint segment
+ * pins, and are updated synchronously in their lane (setAsyncUpdate is cleared).
+ */
+class AnimEngine
+{
+   public:
+    static constexpr const char* TAG = "AnimEngine";
+
+    /** @brief Most lanes, one BatchHAL client per lane */
+    static constexpr int MAX_LANES = ynv::driver::BatchHAL::MAX_CLIENTS;
+
+    /** @brief Default task settings, the dispatcher runs one priority above the lanes */
+    static constexpr uint32_t    DEFAULT_STACK_SIZE = 4096;
+    static constexpr UBaseType_t DEFAULT_PRIORITY   = 5;
+
+    /** @brief Control events and step reports that can be queued without blocking */
+    static constexpr UBaseType_t QUEUE_LENGTH = 16;
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the engine
+     */
+    static AnimEngine& getInstance()
+    {
+        static AnimEngine instance;
+        return instance;
+    }
+
+    /**
+     * @brief Create the dispatcher task
+     * @param hal HAL proxy shared by the displays of all lanes (must be initialized)
+     * @param priority Lane task priority
+     * @param stackSize Stack size of each task in bytes
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue or task could not be created
+     */
+    esp_err_t init(ynv::driver::BatchHAL* hal, UBaseType_t priority = DEFAULT_PRIORITY,
+                   uint32_t stackSize = DEFAULT_STACK_SIZE);
+
+    /**
+     * @brief Add an animation in a new lane
+     * @param anim Animation (must outlive the engine), its display must use the BatchHAL
+     * @param lane Index of the new lane, for the control functions and as source of its events (EventBus)
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized, ESP_ERR_NO_MEM if all lanes are used
+     *         or the lane task could not be created
+     */
+    esp_err_t add(AnimBase* anim, int& lane);
+
+    /** @brief Start the animation of a lane (AnimBase::start) */
+    esp_err_t start(int lane) { return post(lane, COMMAND_START); }
+
+    /** @brief Pause the animation of a lane (AnimBase::pause) */
+    esp_err_t pause(int lane) { return post(lane, COMMAND_PAUSE); }
+
+    /** @brief Resume the animation of a lane (AnimBase::resume) */
+    esp_err_t resume(int lane) { return post(lane, COMMAND_RESUME); }
+
+    /** @brief Abort the animation of a lane (AnimBase::abort) */
+    esp_err_t abort(int lane) { return post(lane, COMMAND_ABORT); }
+
+    /** @brief Toggle the state of the animation of a lane (AnimBase::changeState) */
+    esp_err_t changeState(int lane) { return post(lane, COMMAND_CHANGE_STATE); }
+
+   private:
+    /**
+     * @brief Control commands and lane reports
+     */
+    enum Command_t
+    {
+        COMMAND_START = 0,     ///< AnimBase::start
+        COMMAND_PAUSE,         ///< AnimBase::pause
+        COMMAND_RESUME,        ///< AnimBase::resume
+        COMMAND_ABORT,         ///< AnimBase::abort
+        COMMAND_CHANGE_STATE,  ///< AnimBase::changeState
+        COMMAND_STEPPED,       ///< Lane finished a step (sent by the lane)
+    };
+
+    /**
+     * @brief Event for the dispatcher
+     */
+    struct Event_t
+    {
+        int       lane;        ///< Lane index
+        Command_t command;     ///< Command
+        int64_t   deadlineUs;  ///< Next step of the lane (COMMAND_STEPPED)
+    };
+
+    /**
+     * @brief One animation and its task
+     */
+    struct Lane_t
+    {
+        AnimBase*     anim;        ///< Animation
+        TaskHandle_t  task;        ///< Lane task, steps the animation when notified
+        QueueHandle_t commands;    ///< Commands to apply before the next step
+        int64_t       deadlineUs;  ///< Next step (esp_timer time base), dispatcher only
+        bool          busy;        ///< Stepping, dispatcher only
+        bool          kick;        ///< Command arrived while busy, step again right away, dispatcher only
+    };
+
+    /** @brief Private constructor for singleton */
+    AnimEngine()
+        : m_hal(nullptr),
+          m_task(nullptr),
+          m_queue(nullptr),
+          m_lanes(),
+          m_laneCount(0),
+          m_priority(DEFAULT_PRIORITY),
+          m_stackSize(DEFAULT_STACK_SIZE)
+    {
+    }
+
+    ~AnimEngine()                            = default;
+    AnimEngine(const AnimEngine&)            = delete;
+    AnimEngine& operator=(const AnimEngine&) = delete;
+
+    ynv::driver::BatchHAL*        m_hal;        ///< HAL proxy shared by the lanes
+    TaskHandle_t                  m_task;       ///< Dispatcher task handle
+    QueueHandle_t                 m_queue;      ///< Events for the dispatcher
+    std::array<Lane_t, MAX_LANES> m_lanes;      ///< Lanes
+    int                           m_laneCount;  ///< Lanes in use
+    UBaseType_t                   m_priority;   ///< Lane task priority
+    uint32_t                      m_stackSize;  ///< Task stack size
+
+    /**
+     * @brief Queue a control command for a lane
+     * @param lane Lane index
+     * @param command Command
+     * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown lane, ESP_ERR_TIMEOUT if the queue is full
+     */
+    esp_err_t post(int lane, Command_t command);
+
+    /**
+     * @brief Handle an event in the dispatcher
+     * @param event Event
+     */
+    void handle(const Event_t& event);
+
+    /** @brief Dispatcher task entry point */
+    static void taskEntry(void* arg);
+
+    /** @brief Lane task entry point */
+    static void laneEntry(void* arg);
+
+    /** @brief Wake the lanes when they are due, forever */
+    void run();
+
+    /**
+     * @brief Step the animation of a lane whenever the dispatcher wakes it, forever
+     * @param index Lane index
+     */
+    void runLane(int index);
+};
+
+}  // namespace anim
+}  // namespace ynv
@@ -0,0 +1,63 @@
+/**
+ * @file anim_planner.hpp
+ * @brief Plans the segment switches of a timeline ahead of playing it
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "anim_timeline.hpp"
+
+namespace ynv
+{
+namespace anim
+{
+
+/**
+ * @brief Precomputes per-segment switch schedules of a timeline
+ *
+ * The driver sees one frame at a time and switches every segment that differs from the last one at full
+ * coloring or bleaching time. Knowing the whole sequence, the planner
+ * keeps a segment in its state where it would be toggled back within skipWindowMs (its run of frames in
+ * the other state is shorter than the window and has this state on both sides), so it is not pulsed at all.
+ *
+ * Planning runs once, playing a planned timeline stays a table lookup per frame.
+ */
+class TransitionPlanner
+{
+   public:
+    static constexpr const char* TAG = "TransitionPlanner";
+
+    /**
+     * @brief Planner settings
+     */
+    struct Config_t
+    {
+        uint32_t skipWindowMs;  ///< Keep segments toggled back within this time (ms), 0=never
+        uint32_t rateMs;        ///< Hold time assumed for frames without one (the transition rate)
+    };
+
+    /** @brief No skipping, default transition rate */
+    static constexpr Config_t DEFAULT_CONFIG = {
+        .skipWindowMs = 0,
+        .rateMs       = AnimBase::DEFAULT_TRANSITION_RATE_MS,
+    };
+
+    /**
+     * @brief Plan a timeline
+     * @param timeline Frames as they should look
+     * @param config Planner settings
+     * @return Timeline with the same frames and hold times, skipped switches removed
+     */
+    static Timeline plan(const Timeline& timeline, const Config_t& config = DEFAULT_CONFIG);
+
+    /**
+     * @brief Count the segment switches of one run of a timeline (including the wrap of a loop)
+     * @param timeline Timeline
+     * @return Segments switched
+     */
+    static uint32_t countSwitches(const Timeline& timeline);
+};
+
+}  // namespace anim
+}  // namespace ynv
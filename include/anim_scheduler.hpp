@@ -0,0 +1,176 @@
+/**
+ * @file anim_scheduler.hpp
+ * @brief Event-driven scheduler task for EvalKit animations
+ */
+#pragma once
+
+#include <algorithm>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "evalkit_anims.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+namespace ynv
+{
+namespace anim
+{
+
+/**
+ * @brief Singleton task that steps the selected animation exactly when it is due
+ *
+ * Instead of polling the animation at a fixed rate, the task asks it for its next deadline
+ * (AnimBase::step) and sleeps until then, or until a control event arrives on its queue. Events
+ * are applied in the scheduler task, so selecting an animation never races with a running step.
+ * An idle or paused animation without refresh interval does not wake the task at all.
+ */
+class AnimScheduler
+{
+   public:
+    /** @brief Step callback type, called from the scheduler task after every step */
+    typedef void (*StepCallback_f)(AnimBase& anim);
+
+    static constexpr const char* TAG = "AnimScheduler";
+
+    /** @brief Default task settings */
+    static constexpr uint32_t    DEFAULT_STACK_SIZE = 4096;
+    static constexpr UBaseType_t DEFAULT_PRIORITY   = 5;
+
+    /** @brief Control events that can be queued without blocking */
+    static constexpr UBaseType_t QUEUE_LENGTH = 8;
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the scheduler
+     */
+    static AnimScheduler& getInstance()
+    {
+        static AnimScheduler instance;
+        return instance;
+    }
+
+    /**
+     * @brief Create the event queue and the scheduler task
+     * @param priority Task priority, below ECDDriveTask when asynchronous updates are used
+     * @param stackSize Task stack size in bytes
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue or task could not be created
+     */
+    esp_err_t init(UBaseType_t priority = DEFAULT_PRIORITY, uint32_t stackSize = DEFAULT_STACK_SIZE);
+
+    /**
+     * @brief Select and start an animation (EvalkitAnims::select) in the scheduler task
+     * @param disp Display type to animate
+     * @param anim Animation type to run
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized, ESP_ERR_TIMEOUT if the queue is full
+     */
+    esp_err_t select(ECDEvalkitDisplay_t disp, EvalkitAnims::Anim_t anim) { return post(COMMAND_SELECT, disp, anim); }
+
+    /** @brief Start the selected animation (AnimBase::start), see select() for the return values */
+    esp_err_t start() { return post(COMMAND_START); }
+
+    /** @brief Pause the selected animation (AnimBase::pause), see select() for the return values */
+    esp_err_t pause() { return post(COMMAND_PAUSE); }
+
+    /** @brief Resume the selected animation (AnimBase::resume), see select() for the return values */
+    esp_err_t resume() { return post(COMMAND_RESUME); }
+
+    /** @brief Abort the selected animation (AnimBase::abort), see select() for the return values */
+    esp_err_t abort() { return post(COMMAND_ABORT); }
+
+    /** @brief Toggle the selected animation (AnimBase::changeState), see select() for the return values */
+    esp_err_t changeState() { return post(COMMAND_CHANGE_STATE); }
+
+    /**
+     * @brief Ticks to sleep until a deadline, rounded up so that the sleeper never wakes early
+     * @param deadlineUs Deadline (esp_timer time base), AnimBase::NO_DEADLINE to sleep until an event
+     * @return Ticks for xQueueReceive, portMAX_DELAY for NO_DEADLINE
+     */
+    static TickType_t ticksUntil(int64_t deadlineUs)
+    {
+        constexpr int64_t TICK_US = (int64_t)portTICK_PERIOD_MS * 1000;
+
+        if (deadlineUs == AnimBase::NO_DEADLINE)
+        {
+            return portMAX_DELAY;
+        }
+        int64_t waitUs = std::max<int64_t>(deadlineUs - esp_timer_get_time(), 0);
+        return (TickType_t)std::min<int64_t>((waitUs + TICK_US - 1) / TICK_US, portMAX_DELAY - 1);
+    }
+
+    /**
+     * @brief Register a callback run after every step
+     * @param cb Callback function (nullptr for none), must be registered before init()
+     */
+    void registerStepCallback(StepCallback_f cb) { m_stepCallback = cb; }
+
+   private:
+    /**
+     * @brief Control commands
+     */
+    enum Command_t
+    {
+        COMMAND_SELECT = 0,    ///< Select disp/anim
+        COMMAND_START,         ///< AnimBase::start
+        COMMAND_PAUSE,         ///< AnimBase::pause
+        COMMAND_RESUME,        ///< AnimBase::resume
+        COMMAND_ABORT,         ///< AnimBase::abort
+        COMMAND_CHANGE_STATE,  ///< AnimBase::changeState
+    };
+
+    /**
+     * @brief Queued control event
+     */
+    struct Event_t
+    {
+        Command_t            command;  ///< Command
+        ECDEvalkitDisplay_t  disp;     ///< Display type (COMMAND_SELECT)
+        EvalkitAnims::Anim_t anim;     ///< Animation type (COMMAND_SELECT)
+    };
+
+    /** @brief Private constructor for singleton */
+    AnimScheduler() : m_task(nullptr), m_queue(nullptr), m_stepCallback(nullptr), m_deadlineUs(AnimBase::NO_DEADLINE)
+    {
+    }
+
+    ~AnimScheduler()                               = default;
+    AnimScheduler(const AnimScheduler&)            = delete;
+    AnimScheduler& operator=(const AnimScheduler&) = delete;
+
+    TaskHandle_t   m_task;          ///< Scheduler task handle
+    QueueHandle_t  m_queue;         ///< Control events
+    StepCallback_f m_stepCallback;  ///< Called after every step
+    int64_t        m_deadlineUs;    ///< Next step of the selected animation (esp_timer time base)
+
+    /**
+     * @brief Queue a control event
+     * @param command Command
+     * @param disp Display type (COMMAND_SELECT)
+     * @param anim Animation type (COMMAND_SELECT)
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized, ESP_ERR_TIMEOUT if the queue is full
+     */
+    esp_err_t post(Command_t command, ECDEvalkitDisplay_t disp = ECDEvalkitDisplay_t::EVALKIT_DISP_CNT,
+                   EvalkitAnims::Anim_t anim = EvalkitAnims::ANIM_CNT);
+
+    /**
+     * @brief Apply a control event to the animation manager
+     * @param event Event
+     */
+    void apply(const Event_t& event);
+
+    /**
+     * @brief Step the selected animation and store its next deadline
+     * @param nowUs Current time (esp_timer time base)
+     */
+    void step(int64_t nowUs);
+
+    /** @brief Task entry point */
+    static void taskEntry(void* arg);
+
+    /** @brief Sleep until the next deadline or event, forever */
+    void run();
+};
+
+}  // namespace anim
+}  // namespace ynv
@@ -12,6 +12,7 @@
 #include "anim.hpp"
 #include "disp_test.hpp"
 #include "esp_log.h"
+#include "ynv_trace.hpp"
 
 namespace ynv
 {
@@ -28,7 +29,8 @@ class AnimTest : public Anim<ynv::ecd::DispTest>
 
     void transition() override
     {
-        ESP_LOGI("AnimTest", "Coloring segment. index=%d", m_pos);
+        YNV_TRACE_ANIM_STEP(m_pos);
+        ESP_LOGD("AnimTest", "Coloring segment. index=%d", m_pos);
         m_display->show(m_pos++);
         m_pos %= m_display->getSegmentCount();
     }
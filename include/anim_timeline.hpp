@@ -0,0 +1,264 @@
+/**
+ * @file anim_timeline.hpp
+ * @brief Data-driven animations: timelines of segment masks and hold times
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "anim.hpp"
+#include "ecd.hpp"
+#include "esp_err.h"
+
+namespace ynv
+{
+namespace anim
+{
+
+/**
+ * @brief One frame of a timeline
+ */
+struct Frame_t
+{
+    uint32_t mask;    ///< Segment states (bit i=segment i colored)
+    uint32_t holdMs;  ///< Time the frame is shown (ms), 0=transition rate of the animation
+};
+
+/**
+ * @brief Frames computed at build time, e.g. the digit patterns of a counter
+ * @tparam N Number of frames
+ * @param maskOf Segment states of frame i (constexpr callable)
+ * @return Frames shown for the transition rate of the animation
+ */
+template <size_t N, typename F>
+constexpr std::array<Frame_t, N> makeFrames(F maskOf)
+{
+    std::array<Frame_t, N> frames {};
+    for (size_t i = 0; i < N; ++i)
+    {
+        frames[i] = {.mask = maskOf(i), .holdMs = 0};
+    }
+    return frames;
+}
+
+/**
+ * @brief Sequence of frames, compiled into the firmware or loaded at runtime
+ *
+ * A compiled timeline refers to a constexpr frame array (e.g. generated by tools/ynv_timeline.py --header)
+ * without copying it. A loaded timeline owns its frames, parsed from the binary format written by
+ * tools/ynv_timeline.py --bin (little endian):
+ *
+ *     magic "YNVT" | version u8 | flags u8 (bit 0=loop) | segments u8 | reserved u8 | count u32 |
+ *     count x (mask u32 | holdMs u32)
+ *
+ * Mask bits above the segment count of the display are ignored.
+ */
+class Timeline
+{
+   public:
+    static constexpr const char* TAG = "Timeline";
+
+    /** @brief Binary format identification */
+    static constexpr uint8_t MAGIC[4] = {'Y', 'N', 'V', 'T'};
+    static constexpr uint8_t VERSION  = 1;
+
+    /** @brief Flags of the binary format */
+    static constexpr uint8_t FLAG_LOOP = 0x01;
+
+    /** @brief Most frames accepted by load() */
+    static constexpr uint32_t MAX_FRAMES = 4096;
+
+    /** @brief Empty timeline */
+    Timeline() : m_frames(nullptr), m_count(0), m_loop(false), m_segments(0), m_storage() { }
+
+    /**
+     * @brief Timeline over a frame array compiled into the firmware
+     * @param frames Frames (must outlive the timeline)
+     * @param count Number of frames
+     * @param loop Start over after the last frame instead of completing
+     */
+    Timeline(const Frame_t* frames, size_t count, bool loop = true)
+        : m_frames(frames), m_count(count), m_loop(loop), m_segments(0), m_storage()
+    {
+    }
+
+    /** @brief Timeline over a constexpr frame array */
+    template <size_t N>
+    explicit Timeline(const Frame_t (&frames)[N], bool loop = true) : Timeline(frames, N, loop)
+    {
+    }
+
+    /** @brief Timeline over a constexpr frame array (makeFrames) */
+    template <size_t N>
+    explicit Timeline(const std::array<Frame_t, N>& frames, bool loop = true) : Timeline(frames.data(), N, loop)
+    {
+    }
+
+    /**
+     * @brief Timeline owning its frames
+     * @param frames Frames
+     * @param loop Start over after the last frame instead of completing
+     * @param segments Segment count the frames were made for, 0 if unknown
+     */
+    Timeline(std::vector<Frame_t> frames, bool loop, uint8_t segments = 0)
+        : m_frames(nullptr), m_count(frames.size()), m_loop(loop), m_segments(segments), m_storage(std::move(frames))
+    {
+        m_frames = m_storage.data();
+    }
+
+    Timeline(const Timeline& other) { *this = other; }
+    Timeline& operator=(const Timeline& other);
+
+    /**
+     * @brief Parse a timeline from memory (e.g. a blob embedded with EMBED_FILES or read from a partition)
+     * @param data Binary timeline, copied
+     * @param size Size of data in bytes
+     * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if truncated, ESP_ERR_INVALID_VERSION for an unknown format,
+     *         ESP_ERR_INVALID_ARG for a timeline without frames
+     */
+    esp_err_t load(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Read a timeline from a file of a mounted file system (SPIFFS, LittleFS, FAT)
+     * @param path File path, e.g. "/spiffs/wave.ynvt"
+     * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the file cannot be read, see load(data, size) otherwise
+     */
+    esp_err_t load(const char* path);
+
+    /** @brief Number of frames */
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Get a frame
+     * @param index Frame index (less than size())
+     * @return Frame
+     */
+    const Frame_t& operator[](size_t index) const { return m_frames[index]; }
+
+    /** @brief Start over after the last frame */
+    bool loops() const { return m_loop; }
+
+    /** @brief Segment count the timeline was made for, 0 if unknown */
+    uint8_t segments() const { return m_segments; }
+
+   private:
+    const Frame_t*       m_frames;    ///< Frames, into m_storage when loaded
+    size_t               m_count;     ///< Number of frames
+    bool                 m_loop;      ///< Start over after the last frame
+    uint8_t              m_segments;  ///< Segment count of the source, 0=unknown
+    std::vector<Frame_t> m_storage;   ///< Frames of a loaded timeline
+};
+
+/**
+ * @brief Animation playing a timeline
+ * @tparam DisplayT Display class type, with set(uint32_t mask)
+ *
+ * The first frame is shown on start, every transition shows the next frame and holds it for its own time
+ * (frames without hold time for the transition rate). Evaluating a frame is a table lookup. A timeline that
+ * does not loop completes after the hold time of its last frame.
+ */
+template <typename DisplayT = ynv::ecd::ECDBase>
+class AnimTimeline : public Anim<DisplayT>
+{
+   public:
+    /**
+     * @brief Constructor
+     * @param display Display to animate
+     * @param timeline Timeline to play (at least one frame)
+     */
+    AnimTimeline(std::shared_ptr<DisplayT> display, const Timeline& timeline)
+        : Anim<DisplayT>(display), m_timeline(timeline), m_index(0)
+    {
+    }
+
+    /**
+     * @brief Get the frame shown
+     * @return Frame index
+     */
+    size_t getFrame() const { return m_index; }
+
+    /**
+     * @brief Get the number of frames of the timeline
+     * @return Frames
+     */
+    size_t getFrameCount() const { return m_timeline.size(); }
+
+   protected:
+    void begin() override
+    {
+        m_index = 0;
+        show();
+    }
+
+    /**
+     * @brief Make the frame shown, the next transition continues from it
+     * @param index Frame index
+     */
+    void setFrame(size_t index) { m_index = index; }
+
+    void transition() override
+    {
+        if (m_index + 1 < m_timeline.size())
+        {
+            m_index++;
+        }
+        else if (m_timeline.loops())
+        {
+            m_index = 0;
+        }
+        else
+        {
+            this->complete();
+            return;
+        }
+        show();
+    }
+
+    uint32_t holdMs() const override
+    {
+        if (m_timeline.size() == 0)
+        {
+            return UINT32_MAX;
+        }
+        return (m_timeline[m_index].holdMs > 0) ? m_timeline[m_index].holdMs : this->m_transitionRateMs;
+    }
+
+   private:
+    Timeline m_timeline;  ///< Frames
+    size_t   m_index;     ///< Frame shown
+
+    /** @brief Show the current frame */
+    void show()
+    {
+        if (m_timeline.size() > 0)
+        {
+            this->m_display->set(m_timeline[m_index].mask);
+        }
+    }
+};
+
+/**
+ * @brief Counter playing a looping timeline of its values
+ * @tparam DisplayT Display class type, with set() and set(uint32_t mask)
+ *
+ * Starts with all segments on, the first transition shows the first value.
+ */
+template <typename DisplayT>
+class AnimCounter : public AnimTimeline<DisplayT>
+{
+   public:
+    using AnimTimeline<DisplayT>::AnimTimeline;  // Inherit constructors
+
+   protected:
+    void begin() override
+    {
+        this->m_display->set();
+        this->setFrame(this->getFrameCount() - 1);  // the first transition wraps to the first value
+    }
+};
+
+}  // namespace anim
+}  // namespace ynv
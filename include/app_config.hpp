@@ -21,9 +21,39 @@ struct AppConfig_t
     /** @brief ECD driving mode (true=active, false=passive) */
     bool activeDriving;
 
+    /** @brief Active driving sizes refresh pulses from the learned segment response instead of fixed pulses */
+    bool adaptiveRefresh;
+
+    /** @brief Active driving lengthens state pulses of slow segments and budgets the refresh of failing ones */
+    bool segmentHealth;
+
+    /** @brief Active driving reads and refreshes unchanged segments only when predicted to leave the window */
+    bool predictiveRefresh;
+
+    /** @brief Active driving refreshes a segment only once it left the refresh window, back to the far limit */
+    bool hysteresisRefresh;
+
+    /** @brief Passive driving pulses only segments whose state changed */
+    bool deltaDriving;
+
+    /** @brief Delta driving: maintenance pulse for unchanged segments every N updates (0=disabled) */
+    int maintenanceUpdates;
+
+    /** @brief Delta driving: maintenance pulse for unchanged segments T ms after last drive (0=disabled) */
+    int maintenanceIntervalMs;
+
+    /** @brief Delta driving interleaves sub-pulses over the changed segments instead of one full pulse each */
+    bool interleavedDriving;
+
+    /** @brief Interleaved driving: maximum sub-pulse length (ms) */
+    int subPulseMs;
+
     /** @brief ADC/DAC resolution in bits */
     int analogResolution;
 
+    /** @brief ADC samples per analog read, median filtered (0/1=single sample) */
+    int analogSamples;
+
     /** @brief Maximum segment voltage in DAC units */
     int maxSegmentVoltage;
 
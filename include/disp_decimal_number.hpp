@@ -23,16 +23,16 @@ class DispDecimalNumber : public ECD<15>
                                                PIN_SEG_5,  PIN_SEG_6, PIN_SEG_7,  PIN_SEG_14, PIN_SEG_15,
                                                PIN_SEG_12, PIN_SEG_9, PIN_SEG_10, PIN_SEG_11, PIN_SEG_13};
 
-    void show(uint8_t number1, uint8_t number2, bool dotOrMinus = true)
+    void show(uint8_t number1, uint8_t number2, bool dotOrMinus = true) { set(showMask(number1, number2, dotOrMinus)); }
+
+    /**
+     * @brief Segment states shown by show(), e.g. to compile a counter into a timeline
+     * @return Mask, bit i is segment i
+     */
+    static constexpr uint32_t showMask(uint8_t number1, uint8_t number2, bool dotOrMinus = true)
     {
-        number1 %= 10;                 // Ensure number is within 0-9
-        number2 %= 10;                 // Ensure number is within 0-9
-        m_nextStates[0] = dotOrMinus;  // Set the dotOrMinus state
-        for (int i = 0; i < 7; ++i)
-        {
-            m_nextStates[i + 1] = (numberMask()[number1] >> i) & 1;
-            m_nextStates[i + 8] = (numberMask()[number2] >> i) & 1;
-        }
+        return (dotOrMinus ? 1u : 0u) | ((uint32_t)(numberMask()[number1 % 10] & 0x7f) << 1) |
+               ((uint32_t)(numberMask()[number2 % 10] & 0x7f) << 8);
     }
 
    protected:
@@ -22,14 +22,15 @@ class DispDotNumber : public ECD<8>
     static constexpr std::array<int, 8> PINS {PIN_SEG_6, PIN_SEG_8, PIN_SEG_1, PIN_SEG_2,
                                               PIN_SEG_3, PIN_SEG_4, PIN_SEG_5, PIN_SEG_7};
 
-    void show(uint8_t number, bool dot = true)
+    void show(uint8_t number, bool dot = true) { set(showMask(number, dot)); }
+
+    /**
+     * @brief Segment states shown by show(), e.g. to compile a counter into a timeline
+     * @return Mask, bit i is segment i
+     */
+    static constexpr uint32_t showMask(uint8_t number, bool dot = true)
     {
-        number %= 10;           // Ensure number is within 0-9
-        m_nextStates[0] = dot;  // Set the dot state
-        for (int i = 0; i < 7; ++i)
-        {
-            m_nextStates[i + 1] = (numberMask()[number] >> i) & 1;
-        }
+        return (dot ? 1u : 0u) | ((uint32_t)(numberMask()[number % 10] & 0x7f) << 1);
     }
 
    protected:
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <cassert>
 #include <cinttypes>
 #include <memory>
@@ -14,7 +15,11 @@
 #include "app_config.hpp"
 #include "ecd_drive_active.hpp"
 #include "ecd_drive_base.hpp"
+#include "ecd_drive_interleaved.hpp"
 #include "ecd_drive_passive.hpp"
+#include "ecd_drive_passive_delta.hpp"
+#include "ecd_drive_task.hpp"
+#include "freertos/FreeRTOS.h"
 
 namespace ynv
 {
@@ -56,13 +61,66 @@ class ECDBase
    public:
     ~ECDBase() = default;
 
-    virtual void init()                               = 0;  ///< Initialize the ECD
-    virtual void reset()                              = 0;  ///< Reset to bleach state
-    virtual void set()                                = 0;  ///< Set all segments to color state
-    virtual void set(const std::vector<bool>& states) = 0;  ///< Set specific segment states
-    virtual void update()                             = 0;  ///< Apply pending state changes
-    virtual void toggle()                             = 0;  ///< Toggle all segment states
-    virtual void printConfig() const                  = 0;  ///< Print configuration
+    virtual void init()                                   = 0;  ///< Initialize the ECD
+    virtual void reset()                                  = 0;  ///< Reset to bleach state
+    virtual void set()                                    = 0;  ///< Set all segments to color state
+    virtual void set(const std::vector<bool>& states)     = 0;  ///< Set specific segment states
+    virtual void set(uint32_t mask)                       = 0;  ///< Set segment states from a mask (bit i=segment i)
+    virtual void update()                                 = 0;  ///< Apply pending state changes
+    virtual void toggle()                                 = 0;  ///< Toggle all segment states
+    virtual void toggleTarget()                           = 0;  ///< Toggle the pending target states
+    virtual void printConfig() const                      = 0;  ///< Print configuration
+    virtual void getDriveStats(DriveStats_t& stats) const = 0;  ///< Telemetry of the last update
+
+    /**
+     * @brief Restore the segment health record from NVS and mark it due for saving there (active driving)
+     * @param key NVS key of this display (at most 15 characters, must outlive the display)
+     * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED for passive driving, error code otherwise
+     */
+    virtual esp_err_t loadHealth(const char* key) = 0;
+
+    /**
+     * @brief Set the source of the drive events of this display (EventBus, EVENT_REFRESH_TIMEOUT)
+     * @param source Display identifier, e.g. its EvalkitDisplays index
+     */
+    virtual void setEventSource(uint8_t source) = 0;
+
+    /**
+     * @brief Write the segment health record to NVS now, e.g. before deep sleep or when due (active driving)
+     * @return ESP_OK on success, error code otherwise
+     *
+     * Blocks for the NVS write, call from the application or a low priority task, not from the drive path.
+     * Writes the record of the last completed update, safe while an async update runs.
+     */
+    virtual esp_err_t saveHealth() = 0;
+
+    /**
+     * @brief Check if the segment health record should be written to NVS (active driving)
+     * @return true if saveHealth() is due (save interval elapsed or a segment became failing or recovered)
+     */
+    virtual bool isHealthSaveDue() const = 0;
+
+    /**
+     * @brief Apply pending state changes in the background (ECDDriveTask)
+     * @param cb Completion callback, called from the drive task (nullptr for none)
+     * @return ESP_OK on success, error code otherwise
+     *
+     * Returns immediately. Newer target states supersede a queued or running update.
+     * While an async update runs the drive task owns the current states, do not mix with update().
+     */
+    virtual esp_err_t updateAsync(ECDDriveTask::UpdateCallback_f cb = nullptr) = 0;
+
+    /** @brief Request a running update to stop at the next safe point */
+    virtual void abortUpdate() = 0;
+
+   protected:
+    friend class ECDDriveTask;
+
+    /**
+     * @brief Drive to the states requested by the last updateAsync(), called by ECDDriveTask
+     * @return true if completed, false if aborted
+     */
+    virtual bool driveAsync() = 0;
 };
 
 /**
@@ -82,7 +140,7 @@ class ECD : public ECDBase
      * @param appConfig Application configuration
      */
     explicit ECD(const std::array<int, SEGMENT_COUNT>* pins, const ynv::app::AppConfig_t* appConfig)
-        : m_pins(pins), m_states({}), m_nextStates({}), m_driver(nullptr), m_appConfig(appConfig)
+        : m_pins(pins), m_states({}), m_nextStates({}), m_asyncStates({}), m_driver(nullptr), m_appConfig(appConfig)
     {
         assert(m_appConfig != nullptr);
     }
@@ -94,7 +152,14 @@ class ECD : public ECDBase
      */
     void init() override
     {
-        m_config.maxAnalogValue = (1 << m_appConfig->analogResolution) - 1;
+        m_config.maxAnalogValue        = (1 << m_appConfig->analogResolution) - 1;
+        m_config.adaptiveRefresh       = m_appConfig->adaptiveRefresh;
+        m_config.segmentHealth         = m_appConfig->segmentHealth;
+        m_config.predictiveRefresh     = m_appConfig->predictiveRefresh;
+        m_config.hysteresisRefresh     = m_appConfig->hysteresisRefresh;
+        m_config.maintenanceUpdates    = m_appConfig->maintenanceUpdates;
+        m_config.maintenanceIntervalMs = m_appConfig->maintenanceIntervalMs;
+        m_config.subPulseTime          = m_appConfig->subPulseMs;
         initConfig();
         validateConfig();
 
@@ -104,6 +169,17 @@ class ECD : public ECDBase
             m_driver = std::make_unique<ECDDriveActive<SEGMENT_COUNT>>(
                 &m_config, m_pins, static_cast<ynv::driver::HALBase*>(m_appConfig->hal));
         }
+        else if (m_appConfig->interleavedDriving)
+        {
+            assert(m_config.subPulseTime > 0);
+            m_driver = std::make_unique<ECDDriveInterleaved<SEGMENT_COUNT>>(
+                &m_config, m_pins, static_cast<ynv::driver::HALBase*>(m_appConfig->hal));
+        }
+        else if (m_appConfig->deltaDriving)
+        {
+            m_driver = std::make_unique<ECDDrivePassiveDelta<SEGMENT_COUNT>>(
+                &m_config, m_pins, static_cast<ynv::driver::HALBase*>(m_appConfig->hal));
+        }
         else
         {
             m_driver = std::make_unique<ECDDrivePassive<SEGMENT_COUNT>>(
@@ -127,6 +203,20 @@ class ECD : public ECDBase
         }
     }
 
+    /**
+     * @brief Toggle the target states of all segments
+     *
+     * Same as toggle() after a completed update(). With updateAsync() the current states are written by the
+     * drive task, so this toggles the last requested states instead.
+     */
+    void toggleTarget() override
+    {
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            m_nextStates[i] = !m_nextStates[i];
+        }
+    }
+
     /**
      * @brief Set specific segment states
      * @param states Vector of segment states (true=color, false=bleach)
@@ -137,6 +227,31 @@ class ECD : public ECDBase
         std::copy(states.begin(), states.end(), m_nextStates.begin());
     }
 
+    /**
+     * @brief Set specific segment states without heap allocation
+     * @param mask Segment states, bit i is segment i (1=color, 0=bleach)
+     */
+    void set(uint32_t mask) override
+    {
+        static_assert(SEGMENT_COUNT <= 32, "mask holds at most 32 segments");
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            m_nextStates[i] = (mask >> i) & 1;
+        }
+    }
+
+    /**
+     * @brief Set specific segment states without heap allocation
+     * @param states Segment states, bit i is segment i (1=color, 0=bleach)
+     */
+    void set(const std::bitset<SEGMENT_COUNT>& states)
+    {
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            m_nextStates[i] = states[i];
+        }
+    }
+
     /**
      * @brief Apply pending state changes to hardware
      *
@@ -145,12 +260,88 @@ class ECD : public ECDBase
     void update() override
     {
         assert(m_driver != nullptr);
-        m_driver->drive(m_states, m_nextStates);
+        m_driver->clearAbort();  // an abort raised while idle belongs to no update
+        m_driver->run(m_states, m_nextStates);
+    }
+
+    /**
+     * @brief Apply pending state changes in the background
+     * @param cb Completion callback, called from the drive task (nullptr for none)
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t updateAsync(ECDDriveTask::UpdateCallback_f cb = nullptr) override
+    {
+        assert(m_driver != nullptr);
+
+        taskENTER_CRITICAL(&m_asyncLock);
+        bool supersede = (m_asyncStates != m_nextStates);
+        m_asyncStates  = m_nextStates;
+        taskEXIT_CRITICAL(&m_asyncLock);
+
+        return ECDDriveTask::getInstance().submit(this, cb, supersede);
+    }
+
+    /** @brief Request a running update to stop at the next safe point */
+    void abortUpdate() override
+    {
+        assert(m_driver != nullptr);
+        m_driver->abort();
     }
 
     /** @brief Print ECD configuration parameters */
     void printConfig() const override { m_config.print(); }
 
+    /**
+     * @brief Get the telemetry of the last update
+     * @param stats Copy of the telemetry, safe to call while an async update runs
+     */
+    void getDriveStats(DriveStats_t& stats) const override
+    {
+        assert(m_driver != nullptr);
+        m_driver->getStats(stats);
+    }
+
+    /**
+     * @brief Restore the segment health record from NVS and mark it due for saving there from now on
+     * @param key NVS key of this display (at most 15 characters, must outlive the display)
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t loadHealth(const char* key) override
+    {
+        assert(m_driver != nullptr);
+        return m_driver->loadHealth(key);
+    }
+
+    /**
+     * @brief Set the source of the drive events of this display
+     * @param source Display identifier
+     */
+    void setEventSource(uint8_t source) override
+    {
+        assert(m_driver != nullptr);
+        m_driver->setEventSource(source);
+    }
+
+    /**
+     * @brief Write the segment health record to NVS now
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t saveHealth() override
+    {
+        assert(m_driver != nullptr);
+        return m_driver->saveHealth();
+    }
+
+    /**
+     * @brief Check if the segment health record should be written to NVS
+     * @return true if saveHealth() is due
+     */
+    bool isHealthSaveDue() const override
+    {
+        assert(m_driver != nullptr);
+        return m_driver->isHealthSaveDue();
+    }
+
     /**
      * @brief Get number of segments
      * @return Segment count
@@ -158,14 +349,36 @@ class ECD : public ECDBase
     int getSegmentCount() const { return SEGMENT_COUNT; }
 
    protected:
-    const std::array<int, SEGMENT_COUNT>* m_pins;        ///< Segment pin numbers
-    std::array<bool, SEGMENT_COUNT>       m_states;      ///< Current segment states
-    std::array<bool, SEGMENT_COUNT>       m_nextStates;  ///< Target segment states
-    ECDConfig_t                           m_config;      ///< ECD configuration parameters
+    const std::array<int, SEGMENT_COUNT>* m_pins;         ///< Segment pin numbers
+    std::array<bool, SEGMENT_COUNT>       m_states;       ///< Current segment states
+    std::array<bool, SEGMENT_COUNT>       m_nextStates;   ///< Target segment states
+    std::array<bool, SEGMENT_COUNT>       m_asyncStates;  ///< Target segment states of the last updateAsync()
+    ECDConfig_t                           m_config;       ///< ECD configuration parameters
+
+    /** @brief Protects m_asyncStates between the caller of updateAsync() and the drive task */
+    portMUX_TYPE m_asyncLock = portMUX_INITIALIZER_UNLOCKED;
 
     std::unique_ptr<ECDDriveBase<SEGMENT_COUNT>> m_driver;     ///< Driving algorithm instance
     const ynv::app::AppConfig_t*                 m_appConfig;  ///< Application configuration
 
+    /**
+     * @brief Drive to the states requested by the last updateAsync()
+     * @return true if completed, false if aborted
+     */
+    bool driveAsync() override
+    {
+        assert(m_driver != nullptr);
+
+        // an abort raised after the snapshot stops this drive, the one before belonged to an older target
+        taskENTER_CRITICAL(&m_asyncLock);
+        m_driver->clearAbort();
+        std::array<bool, SEGMENT_COUNT> target = m_asyncStates;
+        taskEXIT_CRITICAL(&m_asyncLock);
+
+        m_driver->run(m_states, target);
+        return !m_driver->isAborted();
+    }
+
     /** @brief Initialize display-specific configuration (pure virtual) */
     virtual void initConfig() = 0;
 
@@ -189,6 +402,9 @@ class ECD : public ECDBase
         assert(m_config.bleachingTime > 0);
         assert(m_config.refreshColorPulseTime > 0);
         assert(m_config.refreshBleachPulseTime > 0);
+        assert(m_config.maintenanceUpdates >= 0);
+        assert(m_config.maintenanceIntervalMs >= 0);
+        assert(m_config.subPulseTime >= 0);
 
         assert(m_config.coloringVoltage < m_config.maxAnalogValue);
         assert(m_config.bleachingVoltage < m_config.maxAnalogValue);
@@ -0,0 +1,136 @@
+/**
+ * @file ecd_adaptive_refresh.hpp
+ * @brief Closed-loop refresh pulse sizing for active ECD driving
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "ecd_drive_base.hpp"
+
+namespace ynv
+{
+namespace ecd
+{
+/**
+ * @brief Learns per segment how far a refresh pulse moves the open-circuit voltage
+ * @tparam SEGMENT_COUNT Number of display segments
+ *
+ * Every refresh pulse is recorded together with the voltage read before it. The next read of the
+ * segment gives the voltage change per ms of pulse (gain), which is filtered per segment and
+ * direction. The following refresh pulse is sized so that the segment lands just past the limit of its
+ * refresh window, instead of repeating fixed-width pulses until it gets there. Pulses are capped at twice
+ * the configured width: every pulse of the refresh loop adds to the update time, a longer pulse from a
+ * wrong gain costs more than the extra read round it saves.
+ *
+ * Segments without a learned gain get the configured refresh pulse time, which also seeds the gain.
+ */
+template <int SEGMENT_COUNT>
+class ECDAdaptiveRefresh
+{
+   private:
+    /**
+     * @brief Learned state of one segment
+     */
+    struct Segment_t
+    {
+        float colorGain;   ///< Voltage rise per ms of color refresh pulse (0=unknown)
+        float bleachGain;  ///< Voltage drop per ms of bleach refresh pulse (0=unknown)
+        int   lastValue;   ///< Voltage read before the last pulse
+        int   lastTime;    ///< Width of the last pulse (ms), 0 if there is nothing to learn from
+        bool  lastColor;   ///< Direction of the last pulse
+    };
+
+    std::array<Segment_t, SEGMENT_COUNT> m_segments;  ///< Learned state per segment
+    const ECDConfig_t*                   m_config;    ///< ECD configuration
+
+   public:
+    /** @brief Weight of a new gain observation (EWMA) */
+    static constexpr float GAIN_WEIGHT = 0.5f;
+
+    /** @brief Longest pulse relative to the configured refresh pulse time, a wrong gain costs at most this much */
+    static constexpr int MAX_PULSE_FACTOR = 2;
+
+    /** @brief Aim this fraction of the refresh window past the limit, so that ADC noise does not cause a retry */
+    static constexpr int AIM_DIVISOR = 16;
+
+    /**
+     * @brief Constructor
+     * @param config ECD configuration parameters
+     */
+    explicit ECDAdaptiveRefresh(const ECDConfig_t* config) : m_segments(), m_config(config) { }
+
+    /** @brief Forget pending observations, called at the start of every drive() */
+    void begin()
+    {
+        for (auto& segment : m_segments)
+        {
+            segment.lastTime = 0;  // the segment relaxed since, a read would not show the pulse alone
+        }
+    }
+
+    /**
+     * @brief Learn from the voltage read after the last refresh pulse of a segment
+     * @param index Segment index
+     * @param value Voltage read now (ADC units)
+     */
+    void observe(int index, int value)
+    {
+        Segment_t& segment = m_segments[index];
+        if (segment.lastTime == 0)
+        {
+            return;
+        }
+
+        // A pulse that did not move the voltage (noise, saturated segment) tells nothing about the gain
+        int moved = segment.lastColor ? (value - segment.lastValue) : (segment.lastValue - value);
+        if (moved > 0)
+        {
+            float& gain = segment.lastColor ? segment.colorGain : segment.bleachGain;
+            float  seen = (float)moved / segment.lastTime;
+            gain        = (gain > 0) ? gain + (seen - gain) * GAIN_WEIGHT : seen;
+        }
+        segment.lastTime = 0;
+    }
+
+    /**
+     * @brief Size the next refresh pulse of a segment and record it
+     * @param index Segment index
+     * @param color Pulse direction (true=color, false=bleach)
+     * @param value Voltage read before the pulse (ADC units)
+     * @return Pulse width (ms)
+     */
+    int pulseTime(int index, bool color, int value)
+    {
+        Segment_t& segment = m_segments[index];
+
+        int   fixed = color ? m_config->refreshColorPulseTime : m_config->refreshBleachPulseTime;
+        float gain  = color ? segment.colorGain : segment.bleachGain;
+        int   time  = fixed;
+
+        if (gain > 0)
+        {
+            // Distance to a point just past the far limit, the check after the pulse is against that limit
+            int distance {0};
+            if (color)
+            {
+                int window = m_config->refreshColorLimitHVoltage - m_config->refreshColorLimitLVoltage;
+                distance   = m_config->refreshColorLimitHVoltage + window / AIM_DIVISOR - value;
+            }
+            else
+            {
+                int window = m_config->refreshBleachLimitHVoltage - m_config->refreshBleachLimitLVoltage;
+                distance   = value - (m_config->refreshBleachLimitLVoltage - window / AIM_DIVISOR);
+            }
+            time = std::clamp((int)(distance / gain) + 1, 1, fixed * MAX_PULSE_FACTOR);
+        }
+
+        segment.lastValue = value;
+        segment.lastTime  = time;
+        segment.lastColor = color;
+        return time;
+    }
+};
+}  // namespace ecd
+}  // namespace ynv
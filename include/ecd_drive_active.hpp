@@ -5,12 +5,16 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
-#include <vector>
+#include <cassert>
 
+#include "ecd_adaptive_refresh.hpp"
 #include "ecd_drive_base.hpp"
+#include "ecd_refresh_scheduler.hpp"
+#include "ecd_segment_health.hpp"
 #include "esp_log.h"
+#include "ynv_hal.hpp"
+#include "ynv_trace.hpp"
 
 namespace ynv
 {
@@ -22,24 +26,68 @@ namespace ecd
  *
  * Provides precise voltage control with analog feedback monitoring
  * and automatic refresh operations to maintain display state.
+ * The health of every segment is tracked (ECDSegmentHealth), with segmentHealth
+ * it sets the state pulse widths and the refresh budget of the segment.
+ * With predictiveRefresh unchanged segments are only read and refreshed when their
+ * predicted voltage is about to leave the refresh window (ECDRefreshScheduler).
+ * With hysteresisRefresh a segment is left alone while its voltage is inside the refresh
+ * window and only driven back to the far limit once it crossed the outer one.
  */
 template <int SEGMENT_COUNT>
 class ECDDriveActive : public ECDDriveBase<SEGMENT_COUNT>
 {
    private:
-    std::vector<int> m_colorPins;          ///< Pins requiring coloring operation
-    std::vector<int> m_bleachPins;         ///< Pins requiring bleaching operation
-    std::vector<int> m_colorRefreshPins;   ///< Pins needing color refresh
-    std::vector<int> m_bleachRefreshPins;  ///< Pins needing bleach refresh
+    std::array<int, SEGMENT_COUNT> m_colorPins;           ///< Pins requiring coloring operation
+    std::array<int, SEGMENT_COUNT> m_bleachPins;          ///< Pins requiring bleaching operation
+    std::array<int, SEGMENT_COUNT> m_colorTimes;          ///< Coloring pulse widths of m_colorPins (ms)
+    std::array<int, SEGMENT_COUNT> m_bleachTimes;         ///< Bleaching pulse widths of m_bleachPins (ms)
+    std::array<int, SEGMENT_COUNT> m_colorRefresh;        ///< Segments needing color refresh (indices)
+    std::array<int, SEGMENT_COUNT> m_bleachRefresh;       ///< Segments needing bleach refresh (indices)
+    size_t                         m_colorCount;          ///< Number of entries in m_colorPins
+    size_t                         m_bleachCount;         ///< Number of entries in m_bleachPins
+    size_t                         m_colorRefreshCount;   ///< Number of entries in m_colorRefresh
+    size_t                         m_bleachRefreshCount;  ///< Number of entries in m_bleachRefresh
+
+    std::array<int, SEGMENT_COUNT>  m_readPins;    ///< Pins of the refresh segments to read
+    std::array<int, SEGMENT_COUNT>  m_readValues;  ///< Voltages read from m_readPins
+    std::array<bool, SEGMENT_COUNT> m_driven;      ///< Refresh pulsed in the running update
+
+    std::array<ynv::driver::Pulse_t, SEGMENT_COUNT> m_pulses;    ///< Pulse queue, at most one pulse per segment
+    ECDAdaptiveRefresh<SEGMENT_COUNT>               m_adaptive;  ///< Learned refresh pulse widths
+    ECDSegmentHealth<SEGMENT_COUNT>                 m_health;    ///< Learned segment health
+    ECDRefreshScheduler<SEGMENT_COUNT>              m_schedule;  ///< Predicted refresh times
 
    public:
+    /**
+     * @brief Constructor
+     * @param config ECD configuration parameters
+     * @param pins Array of GPIO pin numbers for segments
+     * @param hal Hardware abstraction layer instance
+     */
+    explicit ECDDriveActive(const ECDConfig_t* config, const std::array<int, SEGMENT_COUNT>* pins,
+                            ynv::driver::HALBase* hal)
+        : ECDDriveBase<SEGMENT_COUNT>(config, pins, hal),
+          m_colorCount(0),
+          m_bleachCount(0),
+          m_colorRefreshCount(0),
+          m_bleachRefreshCount(0),
+          m_adaptive(config),
+          m_health(config),
+          m_schedule(config)
+    {
+    }
+
     ~ECDDriveActive() = default;
 
     using ECDDriveBase<SEGMENT_COUNT>::TAG;
-    using ECDDriveBase<SEGMENT_COUNT>::ECDDriveBase;  // Inherit constructors
     using ECDDriveBase<SEGMENT_COUNT>::m_pins;
     using ECDDriveBase<SEGMENT_COUNT>::m_config;
     using ECDDriveBase<SEGMENT_COUNT>::m_hal;
+    using ECDDriveBase<SEGMENT_COUNT>::isAborted;
+    using ECDDriveBase<SEGMENT_COUNT>::pulseSegments;
+    using ECDDriveBase<SEGMENT_COUNT>::readSegments;
+    using ECDDriveBase<SEGMENT_COUNT>::setRefreshResult;
+    using ECDDriveBase<SEGMENT_COUNT>::setSegmentHealth;
 
     /** @brief Maximum refresh attempts before timeout */
     static constexpr int MAX_REFRESH_RETRIES = 30;
@@ -55,104 +103,239 @@ class ECDDriveActive : public ECDDriveBase<SEGMENT_COUNT>
     void drive(std::array<bool, SEGMENT_COUNT>&       currentStates,
                const std::array<bool, SEGMENT_COUNT>& nextStates) override
     {
-        // Clear and reserve pin vectors for efficiency
-        m_colorPins.clear();
-        m_bleachPins.clear();
-        m_colorRefreshPins.clear();
-        m_bleachRefreshPins.clear();
-
-        m_colorPins.reserve(SEGMENT_COUNT);
-        m_bleachPins.reserve(SEGMENT_COUNT);
-        m_colorRefreshPins.reserve(SEGMENT_COUNT);
-        m_bleachRefreshPins.reserve(SEGMENT_COUNT);
+        m_colorCount         = 0;
+        m_bleachCount        = 0;
+        m_colorRefreshCount  = 0;
+        m_bleachRefreshCount = 0;
+        m_driven.fill(false);
+        m_health.begin();
+        if (m_config->predictiveRefresh)
+        {
+            m_schedule.begin(m_hal->micros(), currentStates, nextStates);
+        }
 
         // Categorize segments by required operation
         for (int i = 0; i < SEGMENT_COUNT; ++i)
         {
             if (currentStates[i] == nextStates[i])
             {  // Refresh existing state
+                if (m_config->predictiveRefresh && !m_schedule.isDue(i))
+                {
+                    continue;  // predicted to stay inside its refresh window
+                }
+                m_health.refreshing(i, currentStates[i]);
                 if (currentStates[i])
                 {
-                    m_colorRefreshPins.push_back((*m_pins)[i]);
+                    m_colorRefresh[m_colorRefreshCount++] = i;
                 }
                 else
                 {
-                    m_bleachRefreshPins.push_back((*m_pins)[i]);
+                    m_bleachRefresh[m_bleachRefreshCount++] = i;
                 }
             }
             else
             {  // Change state
                 if (nextStates[i])
                 {
-                    m_colorPins.push_back((*m_pins)[i]);
+                    m_colorTimes[m_colorCount]  = stateTime(i, true);
+                    m_colorPins[m_colorCount++] = (*m_pins)[i];
                 }
                 else
                 {
-                    m_bleachPins.push_back((*m_pins)[i]);
+                    m_bleachTimes[m_bleachCount]  = stateTime(i, false);
+                    m_bleachPins[m_bleachCount++] = (*m_pins)[i];
                 }
+                m_health.switched(i);
+                m_schedule.switched(i);
                 currentStates[i] = nextStates[i];
             }
         }
 
-        // Execute state changes
-        for (const auto& pin : m_colorPins)
-        {
-            m_hal->digitalWrite(pin, true, m_config->coloringTime,
-                                (m_config->maxAnalogValue - m_config->coloringVoltage));
-        }
-        for (const auto& pin : m_bleachPins)
-        {
-            m_hal->digitalWrite(pin, false, m_config->bleachingTime, m_config->bleachingVoltage);
-        }
+        // Execute state changes in one pulse queue, grouped by common voltage
+        size_t count {0};
+        count = queuePulses(count, m_colorPins.data(), m_colorTimes.data(), m_colorCount, true,
+                            (m_config->maxAnalogValue - m_config->coloringVoltage));
+        count = queuePulses(count, m_bleachPins.data(), m_bleachTimes.data(), m_bleachCount, false,
+                            m_config->bleachingVoltage);
+        pulseSegments(m_pulses.data(), count, false);
 
-        // Refresh loop with voltage monitoring
-        bool done {m_colorRefreshPins.size() == 0 && m_bleachRefreshPins.size() == 0};
+        // Refresh loop with voltage monitoring, states are consistent here so it can be aborted
+        m_adaptive.begin();
+        bool done {m_colorRefreshCount == 0 && m_bleachRefreshCount == 0};
         int  retries {0};
-        while (!done && retries < MAX_REFRESH_RETRIES)
+        while (!done && retries < MAX_REFRESH_RETRIES && !isAborted())
         {
-            // Remove segments that have reached target voltage
-            m_colorRefreshPins.erase(std::remove_if(m_colorRefreshPins.begin(), m_colorRefreshPins.end(),
-                                                    [&](int pin)
-                                                    {
-                                                        int analogVal = m_hal->analogRead(pin);
-                                                        return analogVal >= m_config->refreshColorLimitHVoltage;
-                                                    }),
-                                     m_colorRefreshPins.end());
-
-            m_bleachRefreshPins.erase(std::remove_if(m_bleachRefreshPins.begin(), m_bleachRefreshPins.end(),
-                                                     [&](int pin)
-                                                     {
-                                                         int analogVal = m_hal->analogRead(pin);
-                                                         return analogVal <= m_config->refreshBleachLimitLVoltage;
-                                                     }),
-                                      m_bleachRefreshPins.end());
+            // Read all segments, drop those that reached the target voltage and queue pulses for the rest
+            esp_err_t err = ESP_OK;
+            count         = queueRefresh(0, m_colorRefresh.data(), m_colorRefreshCount, true, err);
+            count         = queueRefresh(count, m_bleachRefresh.data(), m_bleachRefreshCount, false, err);
 
             retries++;
-            done = (m_colorRefreshPins.size() == 0 && m_bleachRefreshPins.size() == 0);
+            done = (count == 0 && err == ESP_OK);  // a failed scan is retried, it proves nothing
 
             if (!done)
             {
-                ESP_LOGI(TAG, "Refresh attempt %d", retries);
-
-                // Apply refresh pulses to remaining segments
-                for (const auto& pin : m_colorRefreshPins)
-                {
-                    m_hal->digitalWrite(pin, true, m_config->refreshColorPulseTime,
-                                        (m_config->maxAnalogValue - m_config->refreshColoringVoltage));
-                }
-
-                for (const auto& pin : m_bleachRefreshPins)
-                {
-                    m_hal->digitalWrite(pin, false, m_config->refreshBleachPulseTime,
-                                        m_config->refreshBleachingVoltage);
-                }
+                YNV_TRACE_REFRESH(retries, count);
+                ESP_LOGD(TAG, "Refresh attempt %d", retries);
+                pulseSegments(m_pulses.data(), count, true);
             }
         }
 
-        if (!done)
+        setRefreshResult(retries, !done && !isAborted());
+
+        if (!done && !isAborted())
         {
             ESP_LOGW(TAG, "Refresh operation did not complete within %d retries", MAX_REFRESH_RETRIES);
         }
+
+        // An aborted update says nothing about how much refresh the segments need
+        if (!isAborted())
+        {
+            m_health.end();
+        }
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            setSegmentHealth(i, m_health.get(i));
+        }
+    }
+
+    /**
+     * @brief Restore the segment health record from NVS and keep saving it there
+     * @param key NVS key of this display (at most 15 characters, must outlive the driver)
+     * @return ESP_OK on success, error code otherwise (the record starts empty)
+     */
+    esp_err_t loadHealth(const char* key) override { return m_health.load(key); }
+
+    /**
+     * @brief Write the segment health record of the last completed update to NVS now
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if loadHealth() was not called
+     */
+    esp_err_t saveHealth() override { return m_health.save(); }
+
+    /**
+     * @brief Check if the segment health record should be written to NVS
+     * @return true if saveHealth() is due
+     */
+    bool isHealthSaveDue() const override { return m_health.isSaveDue(); }
+
+   private:
+    /**
+     * @brief Append one pulse per pin to the pulse queue
+     * @param count Number of queued pulses
+     * @param pins Pins to pulse
+     * @param timesMs Pulse width per pin (ms)
+     * @param pinCount Number of pins
+     * @param high Pulse direction (true=color, false=bleach)
+     * @param common Common electrode voltage
+     * @return Number of queued pulses
+     */
+    size_t queuePulses(size_t count, const int* pins, const int* timesMs, size_t pinCount, bool high, int common)
+    {
+        for (size_t i = 0; i < pinCount; ++i)
+        {
+            assert(count < m_pulses.size());
+            m_pulses[count++] = {.pin = pins[i], .high = high, .durationUs = timesMs[i] * 1000, .common = common};
+        }
+        return count;
+    }
+
+    /**
+     * @brief Width of the state pulse of a segment
+     * @param index Segment index
+     * @param color Target state (true=color, false=bleach)
+     * @return Pulse width (ms)
+     */
+    int stateTime(int index, bool color) const
+    {
+        if (m_config->segmentHealth)
+        {
+            return m_health.pulseTime(index, color);
+        }
+        return color ? m_config->coloringTime : m_config->bleachingTime;
+    }
+
+    /**
+     * @brief Check if a refresh segment needs no (further) refresh pulse
+     * @param index Segment index
+     * @param value Voltage read (ADC units)
+     * @param color Refresh direction (true=color, false=bleach)
+     * @return true if the segment is done
+     *
+     * A segment is driven to the far limit of the refresh window. With hysteresisRefresh a segment that
+     * was not driven in this update yet is done anywhere inside the window, down to the outer limit.
+     */
+    bool inWindow(int index, int value, bool color) const
+    {
+        if (m_config->hysteresisRefresh && !m_driven[index])
+        {
+            return color ? value >= m_config->refreshColorLimitLVoltage : value <= m_config->refreshBleachLimitHVoltage;
+        }
+        return color ? value >= m_config->refreshColorLimitHVoltage : value <= m_config->refreshBleachLimitLVoltage;
+    }
+
+    /**
+     * @brief Read refresh segments, drop those within the refresh window and queue pulses for the rest
+     * @param count Number of queued pulses
+     * @param segments Segment indices needing refresh (compacted in-place)
+     * @param segmentCount Number of entries in segments (updated)
+     * @param color Refresh direction (true=color, false=bleach)
+     * @param err Set to the error of a failed scan, the segments are then kept without pulses
+     * @return Number of queued pulses
+     */
+    size_t queueRefresh(size_t count, int* segments, size_t& segmentCount, bool color, esp_err_t& err)
+    {
+        int common = color ? (m_config->maxAnalogValue - m_config->refreshColoringVoltage)
+                           : m_config->refreshBleachingVoltage;
+
+        // read all refresh segments in one scan
+        for (size_t k = 0; k < segmentCount; ++k)
+        {
+            m_readPins[k] = (*m_pins)[segments[k]];
+        }
+        esp_err_t scan = readSegments(m_readPins.data(), segmentCount, m_readValues.data());
+        if (scan != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Refresh scan failed (%s)", esp_err_to_name(scan));
+            err = scan;
+            return count;
+        }
+        int64_t now = m_hal->micros();
+
+        size_t kept = 0;
+        for (size_t k = 0; k < segmentCount; ++k)
+        {
+            int i         = segments[k];
+            int analogVal = m_readValues[k];
+            m_schedule.read(i, analogVal, now, color);
+            if (m_config->adaptiveRefresh)
+            {
+                m_adaptive.observe(i, analogVal);
+            }
+            if (inWindow(i, analogVal, color))
+            {
+                m_health.reached(i);
+                continue;
+            }
+            if (m_config->segmentHealth && !m_health.canRefresh(i))
+            {
+                continue;  // failing segment, do not hold the others in the refresh loop
+            }
+
+            int timeMs = color ? m_config->refreshColorPulseTime : m_config->refreshBleachPulseTime;
+            if (m_config->adaptiveRefresh)
+            {
+                timeMs = m_adaptive.pulseTime(i, color, analogVal);
+            }
+
+            assert(count < m_pulses.size());
+            m_pulses[count++] = {.pin = m_readPins[k], .high = color, .durationUs = timeMs * 1000, .common = common};
+            segments[kept++]  = i;
+            m_driven[i]       = true;
+            m_health.pulsed(i);
+            m_schedule.pulsed(i);
+        }
+        segmentCount = kept;
+        return count;
     }
 };
 }  // namespace ecd
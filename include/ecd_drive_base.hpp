@@ -4,9 +4,14 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 
+#include "ecd_drive_stats.hpp"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "ynv_event_bus.hpp"
 #include "ynv_hal.hpp"
 
 namespace ynv
@@ -46,6 +51,18 @@ struct ECDConfig_t
     int refreshBleachLimitHVoltage;  ///< High voltage threshold for bleach refresh
     int refreshBleachLimitLVoltage;  ///< Low voltage threshold for bleach refresh
 
+    bool adaptiveRefresh;    ///< Size refresh pulses from the learned segment response (active driving)
+    bool segmentHealth;      ///< Pre-compensate slow segments and budget failing ones (active driving)
+    bool predictiveRefresh;  ///< Refresh unchanged segments only when predicted to leave the window (active driving)
+    bool hysteresisRefresh;  ///< Refresh a segment only once it left the window, back to the far limit (active)
+
+    // Maintenance Configs (delta driving)
+    int maintenanceUpdates;     ///< Maintenance pulse every N updates (0=disabled)
+    int maintenanceIntervalMs;  ///< Maintenance pulse after T ms since last drive (0=disabled)
+
+    // Interleaved Configs
+    int subPulseTime;  ///< Maximum sub-pulse duration (ms)
+
     /**
      * @brief Print configuration parameters to log
      */
@@ -67,6 +84,13 @@ struct ECDConfig_t
         ESP_LOGI(TAG, "refreshBleachPulseTime     | %d", refreshBleachPulseTime);
         ESP_LOGI(TAG, "refreshBleachLimitHVoltage | %d", refreshBleachLimitHVoltage);
         ESP_LOGI(TAG, "refreshBleachLimitLVoltage | %d", refreshBleachLimitLVoltage);
+        ESP_LOGI(TAG, "adaptiveRefresh            | %d", adaptiveRefresh);
+        ESP_LOGI(TAG, "segmentHealth              | %d", segmentHealth);
+        ESP_LOGI(TAG, "predictiveRefresh          | %d", predictiveRefresh);
+        ESP_LOGI(TAG, "hysteresisRefresh          | %d", hysteresisRefresh);
+        ESP_LOGI(TAG, "maintenanceUpdates         | %d", maintenanceUpdates);
+        ESP_LOGI(TAG, "maintenanceIntervalMs      | %d", maintenanceIntervalMs);
+        ESP_LOGI(TAG, "subPulseTime               | %d", subPulseTime);
         ESP_LOGI(TAG, "-------------------------------------------------------------");
     }
 };
@@ -91,8 +115,23 @@ class ECDDriveBase
      */
     explicit ECDDriveBase(const ECDConfig_t* config, const std::array<int, SEGMENT_COUNT>* pins,
                           ynv::driver::HALBase* hal)
-        : m_config(config), m_pins(pins), m_hal(hal)
+        : m_config(config),
+          m_pins(pins),
+          m_hal(hal),
+          m_abort(false),
+          m_stats(),
+          m_published(),
+          m_latencies(),
+          m_latencyCount(0),
+          m_eventSource(0)
     {
+        static_assert(SEGMENT_COUNT <= DriveStats_t::MAX_SEGMENTS, "DriveStats_t holds at most MAX_SEGMENTS");
+        m_stats.segmentCount = SEGMENT_COUNT;
+        for (auto& segment : m_stats.segments)
+        {
+            segment.lastAnalog = -1;
+        }
+        m_published = m_stats;
     }
 
     virtual ~ECDDriveBase() = default;
@@ -108,12 +147,253 @@ class ECDDriveBase
     virtual void drive(std::array<bool, SEGMENT_COUNT>&       currentStates,
                        const std::array<bool, SEGMENT_COUNT>& nextStates) = 0;
 
+    /**
+     * @brief Drive the segments and record the telemetry of the update
+     * @param currentStates Current segment states (modified in-place)
+     * @param nextStates Target segment states
+     */
+    void run(std::array<bool, SEGMENT_COUNT>& currentStates, const std::array<bool, SEGMENT_COUNT>& nextStates)
+    {
+        std::array<bool, SEGMENT_COUNT> before = currentStates;
+
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            m_stats.segments[i].pulses        = 0;
+            m_stats.segments[i].refreshPulses = 0;
+            m_stats.segments[i].charge        = 0;
+        }
+        m_stats.refreshRetries = 0;
+        m_stats.timedOut       = false;
+
+        int64_t start = m_hal->micros();
+        drive(currentStates, nextStates);
+        m_stats.durationUs = m_hal->micros() - start;
+
+        m_stats.colored  = 0;
+        m_stats.bleached = 0;
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            if (before[i] != currentStates[i])
+            {
+                (currentStates[i] ? m_stats.colored : m_stats.bleached)++;
+            }
+            SegmentStats_t& segment = m_stats.segments[i];
+            segment.refreshRate += (segment.refreshPulses - segment.refreshRate) / REFRESH_RATE_UPDATES;
+        }
+        m_stats.aborted = isAborted();
+        m_stats.updates++;
+        m_stats.timeouts += m_stats.timedOut ? 1 : 0;
+
+        taskENTER_CRITICAL(&m_statsLock);
+        m_published                                         = m_stats;
+        m_latencies[m_latencyCount++ % m_latencies.size()] = m_stats.durationUs;
+        taskEXIT_CRITICAL(&m_statsLock);
+    }
+
+    /**
+     * @brief Get the telemetry of the last drive()
+     * @param stats Copy of the telemetry
+     *
+     * The latency percentiles are computed here rather than on every drive(), polling is the rare case.
+     */
+    void getStats(DriveStats_t& stats) const
+    {
+        taskENTER_CRITICAL(&m_statsLock);
+        stats            = m_published;
+        auto   latencies = m_latencies;
+        size_t n         = std::min(m_latencyCount, m_latencies.size());
+        taskEXIT_CRITICAL(&m_statsLock);
+
+        if (n == 0)
+        {
+            return;
+        }
+
+        // nearest rank
+        size_t p50 = (n - 1) / 2;
+        size_t p99 = (n * 99 + 99) / 100 - 1;
+        std::nth_element(latencies.begin(), latencies.begin() + p99, latencies.begin() + n);
+        std::nth_element(latencies.begin(), latencies.begin() + p50, latencies.begin() + p99);
+        stats.p50Us = latencies[p50];
+        stats.p99Us = latencies[p99];
+    }
+
+    /**
+     * @brief Restore the segment health record from NVS and mark it due for saving there from now on
+     * @param key NVS key of this display (at most 15 characters, must outlive the driver)
+     * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the driver does not track segment health
+     */
+    virtual esp_err_t loadHealth(const char* key)
+    {
+        (void)key;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    /**
+     * @brief Write the segment health record of the last completed update to NVS now
+     * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the driver does not track segment health
+     */
+    virtual esp_err_t saveHealth() { return ESP_ERR_NOT_SUPPORTED; }
+
+    /**
+     * @brief Check if the segment health record should be written to NVS
+     * @return true if saveHealth() is due, false if not or if the driver does not track segment health
+     */
+    virtual bool isHealthSaveDue() const { return false; }
+
+    /**
+     * @brief Request the running drive() to stop at the next safe point
+     *
+     * Used to supersede in-flight work with newer target states. Segments that were not
+     * pulsed keep a state for which the next drive() pulses them again.
+     */
+    void abort() { m_abort.store(true); }
+
+    /** @brief Clear a pending abort request, called before drive() */
+    void clearAbort() { m_abort.store(false); }
+
+    /** @brief Check if the last drive() was aborted */
+    bool isAborted() const { return m_abort.load(); }
+
+    /**
+     * @brief Set the source of the events this driver publishes (EventBus, EVENT_REFRESH_TIMEOUT)
+     * @param source Display the driver belongs to
+     */
+    void setEventSource(uint8_t source) { m_eventSource = source; }
+
    protected:
     static constexpr const char* TAG = "ECDDrive";
 
+    /** @brief Updates averaged by SegmentStats_t::refreshRate */
+    static constexpr float REFRESH_RATE_UPDATES = 16.0f;
+
+    /**
+     * @brief Run a pulse queue and count the pulses per segment
+     * @param pulses Pulses in execution order
+     * @param count Number of pulses
+     * @param refresh Refresh or maintenance pulses
+     * @return ESP_OK on success, first error code otherwise
+     */
+    esp_err_t pulseSegments(const ynv::driver::Pulse_t* pulses, size_t count, bool refresh)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            countPulse(pulses[i].pin, pulses[i].high, pulses[i].durationUs / 1000, pulses[i].common, refresh);
+        }
+        return m_hal->pulse(pulses, count);
+    }
+
+    /**
+     * @brief Pulse a group of pins with digitalWriteMany and count the pulses per segment
+     * @param pins Pin numbers to write to
+     * @param count Number of pins
+     * @param high Logic level (true=HIGH, false=LOW)
+     * @param delay Duration to hold state per pin (milliseconds)
+     * @param common Common electrode voltage (DAC units)
+     * @param refresh Refresh or maintenance pulses
+     * @return ESP_OK on success, first error code otherwise
+     */
+    esp_err_t writeSegments(const int* pins, size_t count, bool high, int delay, int common, bool refresh)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            countPulse(pins[i], high, delay, common, refresh);
+        }
+        return m_hal->digitalWriteMany(pins, count, high, delay, common);
+    }
+
+    /**
+     * @brief Read a group of pins with analogReadMany and keep the values per segment
+     * @param pins Pin numbers to read from
+     * @param count Number of pins
+     * @param values Analog values per pin, <0 on error
+     * @return ESP_OK on success, first error code otherwise
+     */
+    esp_err_t readSegments(const int* pins, size_t count, int* values)
+    {
+        esp_err_t err = m_hal->analogReadMany(pins, count, values);
+        for (size_t i = 0; i < count; ++i)
+        {
+            int segment = segmentOf(pins[i]);
+            if (segment >= 0)
+            {
+                m_stats.segments[segment].lastAnalog = (int16_t)values[i];
+            }
+        }
+        return err;
+    }
+
+    /**
+     * @brief Record the refresh result of the running drive()
+     * @param retries Refresh iterations
+     * @param timedOut Refresh loop gave up before all segments reached their window, published as
+     *                 EVENT_REFRESH_TIMEOUT
+     */
+    void setRefreshResult(int retries, bool timedOut)
+    {
+        m_stats.refreshRetries = retries;
+        m_stats.timedOut       = timedOut;
+        if (timedOut)
+        {
+            ynv::driver::EventBus::getInstance().publish(ynv::driver::EVENT_REFRESH_TIMEOUT, m_eventSource, retries);
+        }
+    }
+
+    /**
+     * @brief Record the health of a segment with the telemetry of the running drive()
+     * @param segment Segment index
+     * @param health Health record
+     */
+    void setSegmentHealth(int segment, const SegmentHealth_t& health) { m_stats.segments[segment].health = health; }
+
     const ECDConfig_t*                    m_config;  ///< ECD configuration parameters
     const std::array<int, SEGMENT_COUNT>* m_pins;    ///< GPIO pin assignments for segments
     ynv::driver::HALBase*                 m_hal;     ///< Hardware abstraction layer
+
+    std::atomic<bool> m_abort;  ///< Abort requested for the running drive()
+
+   private:
+    DriveStats_t m_stats;      ///< Telemetry of the running drive()
+    DriveStats_t m_published;  ///< Telemetry of the last completed drive(), read by getStats()
+
+    std::array<int64_t, DriveStats_t::LATENCY_WINDOW> m_latencies;     ///< Recent drive() times (ring)
+    size_t                                            m_latencyCount;  ///< drive() times recorded
+    uint8_t                                           m_eventSource;   ///< Source of the published events
+
+    /** @brief Protects m_published between the drive task and pollers */
+    mutable portMUX_TYPE m_statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+    /**
+     * @brief Find the segment index of a pin
+     * @return Segment index, -1 if the pin is not a segment of this display
+     */
+    int segmentOf(int pin) const
+    {
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            if ((*m_pins)[i] == pin)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /** @brief Count one pulse of a segment */
+    void countPulse(int pin, bool high, int timeMs, int common, bool refresh)
+    {
+        int segment = segmentOf(pin);
+        if (segment < 0)
+        {
+            return;
+        }
+
+        int             voltage = high ? (m_config->maxAnalogValue - common) : -common;
+        SegmentStats_t& stats   = m_stats.segments[segment];
+        stats.pulses++;
+        stats.refreshPulses += refresh ? 1 : 0;
+        stats.charge += voltage * timeMs;
+    }
 };
 }  // namespace ecd
 }  // namespace ynv
\ No newline at end of file
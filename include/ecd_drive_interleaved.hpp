@@ -0,0 +1,112 @@
+/**
+ * @file ecd_drive_interleaved.hpp
+ * @brief Time-multiplexed (interleaved) driving implementation for ECDs
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "ecd_drive_passive_delta.hpp"
+#include "ynv_hal.hpp"
+
+namespace ynv
+{
+namespace ecd
+{
+/**
+ * @brief Delta passive ECD driver that interleaves short sub-pulses over the changed segments
+ * @tparam SEGMENT_COUNT Number of display segments
+ *
+ * The multiplexer connects one segment at a time. Instead of holding each changed segment for the full
+ * coloring/bleaching time, the segments of a group are driven round-robin with pulses of at most
+ * ECDConfig_t::subPulseTime until each has received the full pulse time. Electrochromic cells integrate
+ * the charge, so the segments of a group change together instead of one after the other. Total pulse
+ * time, unchanged segments and maintenance pulses are the same as with ECDDrivePassiveDelta.
+ *
+ * The first round covers both groups, so every changed segment starts changing within it. The remaining
+ * bleach rounds follow at the same common voltage and the remaining color rounds last, which costs one
+ * extra DAC write per update instead of one per sub-pulse.
+ */
+template <int SEGMENT_COUNT>
+class ECDDriveInterleaved : public ECDDrivePassiveDelta<SEGMENT_COUNT>
+{
+   private:
+    using Group_t = typename ECDDrivePassiveDelta<SEGMENT_COUNT>::Group_t;
+
+    /**
+     * @brief Segments sharing pulse direction and common voltage
+     */
+    struct SubPulse_t
+    {
+        const int* pins;    ///< Pins of the group
+        size_t     count;   ///< Number of entries in pins
+        bool       high;    ///< Pulse direction (true=color, false=bleach)
+        int        common;  ///< Common electrode voltage (DAC units)
+        int        left;    ///< Pulse time still to deliver per segment (ms)
+    };
+
+   public:
+    ~ECDDriveInterleaved() = default;
+
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::ECDDrivePassiveDelta;  // Inherit constructors
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::m_config;
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::isAborted;
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::writeSegments;
+
+   protected:
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::m_colorPins;
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::m_bleachPins;
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::m_colorCount;
+    using ECDDrivePassiveDelta<SEGMENT_COUNT>::m_bleachCount;
+
+    /**
+     * @brief Pulse the state changes of the update in interleaved sub-pulses
+     * @return GROUP_BLEACH if both groups received their full pulse time, GROUP_NONE after an abort
+     *
+     * An abort stops between sub-pulses, all changed segments are driven again on the next update.
+     */
+    Group_t pulseStates() override
+    {
+        SubPulse_t color  = {.pins   = m_colorPins.data(),
+                             .count  = m_colorCount,
+                             .high   = true,
+                             .common = m_config->maxAnalogValue - m_config->coloringVoltage,
+                             .left   = (m_colorCount > 0) ? m_config->coloringTime : 0};
+        SubPulse_t bleach = {.pins   = m_bleachPins.data(),
+                             .count  = m_bleachCount,
+                             .high   = false,
+                             .common = m_config->bleachingVoltage,
+                             .left   = (m_bleachCount > 0) ? m_config->bleachingTime : 0};
+
+        subPulse(color);
+        subPulse(bleach);
+        while (bleach.left > 0 && !isAborted())
+        {
+            subPulse(bleach);
+        }
+        while (color.left > 0 && !isAborted())
+        {
+            subPulse(color);
+        }
+
+        return (color.left > 0 || bleach.left > 0) ? Group_t::GROUP_NONE : Group_t::GROUP_BLEACH;
+    }
+
+   private:
+    /** @brief Apply one sub-pulse to every segment of a group */
+    void subPulse(SubPulse_t& group)
+    {
+        if (group.left <= 0 || isAborted())
+        {
+            return;
+        }
+
+        int delay = std::min(m_config->subPulseTime, group.left);
+        writeSegments(group.pins, group.count, group.high, delay, group.common, false);
+        group.left -= delay;
+    }
+};
+}  // namespace ecd
+}  // namespace ynv
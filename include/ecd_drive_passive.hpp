@@ -29,7 +29,8 @@ class ECDDrivePassive : public ECDDriveBase<SEGMENT_COUNT>
     using ECDDriveBase<SEGMENT_COUNT>::ECDDriveBase;  // Inherit constructors
     using ECDDriveBase<SEGMENT_COUNT>::m_pins;
     using ECDDriveBase<SEGMENT_COUNT>::m_config;
-    using ECDDriveBase<SEGMENT_COUNT>::m_hal;
+    using ECDDriveBase<SEGMENT_COUNT>::isAborted;
+    using ECDDriveBase<SEGMENT_COUNT>::writeSegments;
 
     /**
      * @brief Drive ECD segments with passive control
@@ -38,19 +39,38 @@ class ECDDrivePassive : public ECDDriveBase<SEGMENT_COUNT>
      *
      * Applies coloring or bleaching voltage to each segment based on target state.
      * No feedback monitoring - relies on fixed timing parameters.
+     * Segments are pulsed grouped by target state, so the common voltage is set once per group.
      */
     void drive(std::array<bool, SEGMENT_COUNT>&       currentStates,
                const std::array<bool, SEGMENT_COUNT>& nextStates) override
     {
+        std::array<int, SEGMENT_COUNT> colorPins;
+        std::array<int, SEGMENT_COUNT> bleachPins;
+        size_t                         colorCount {0};
+        size_t                         bleachCount {0};
+
+        // Group segments by desired state (true=color, false=bleach), each group shares one common voltage
         for (int i = 0; i < SEGMENT_COUNT; ++i)
         {
-            // Apply voltage based on desired state (true=color, false=bleach)
-            m_hal->digitalWrite(
-                (*m_pins)[i], nextStates[i], nextStates[i] ? m_config->coloringTime : m_config->bleachingTime,
-                nextStates[i] ? (m_config->maxAnalogValue - m_config->coloringVoltage) : m_config->bleachingVoltage);
-
+            if (nextStates[i])
+            {
+                colorPins[colorCount++] = (*m_pins)[i];
+            }
+            else
+            {
+                bleachPins[bleachCount++] = (*m_pins)[i];
+            }
             currentStates[i] = nextStates[i];  // Update current state
         }
+
+        writeSegments(colorPins.data(), colorCount, true, m_config->coloringTime,
+                      (m_config->maxAnalogValue - m_config->coloringVoltage), false);
+        if (isAborted())
+        {
+            return;  // all segments are driven again on the next update
+        }
+        writeSegments(bleachPins.data(), bleachCount, false, m_config->bleachingTime, m_config->bleachingVoltage,
+                      false);
     }
 };
 }  // namespace ecd
@@ -0,0 +1,236 @@
+/**
+ * @file ecd_drive_passive_delta.hpp
+ * @brief Delta-only passive driving implementation for ECDs
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ecd_drive_base.hpp"
+#include "ynv_hal.hpp"
+
+namespace ynv
+{
+namespace ecd
+{
+/**
+ * @brief Passive ECD driver that pulses only changed segments
+ * @tparam SEGMENT_COUNT Number of display segments
+ *
+ * Like ECDDrivePassive, but segments whose state did not change are left alone.
+ * Unchanged segments optionally get a short maintenance pulse (refresh voltage and pulse time)
+ * every ECDConfig_t::maintenanceUpdates updates or ECDConfig_t::maintenanceIntervalMs after
+ * they were last driven, to counter the slow fading of the display memory.
+ */
+template <int SEGMENT_COUNT>
+class ECDDrivePassiveDelta : public ECDDriveBase<SEGMENT_COUNT>
+{
+   protected:
+    /**
+     * @brief Pulse groups in drive order
+     */
+    enum Group_t : uint8_t
+    {
+        GROUP_NONE = 0,       ///< Not pulsed
+        GROUP_COLOR,          ///< Coloring pulse
+        GROUP_BLEACH,         ///< Bleaching pulse
+        GROUP_COLOR_REFRESH,  ///< Color maintenance pulse
+        GROUP_BLEACH_REFRESH  ///< Bleach maintenance pulse
+    };
+
+    std::array<bool, SEGMENT_COUNT>    m_driven;              ///< State known (driven, not skipped by an abort)
+    std::array<int64_t, SEGMENT_COUNT> m_lastDriveUs;         ///< Time of the last pulse per segment
+    std::array<int, SEGMENT_COUNT>     m_updatesSinceDriven;  ///< Updates since the last pulse per segment
+    std::array<int, SEGMENT_COUNT>     m_colorPins;           ///< Pins requiring coloring operation
+    std::array<int, SEGMENT_COUNT>     m_bleachPins;          ///< Pins requiring bleaching operation
+    std::array<int, SEGMENT_COUNT>     m_colorRefreshPins;    ///< Unchanged pins due for a color maintenance pulse
+    std::array<int, SEGMENT_COUNT>     m_bleachRefreshPins;   ///< Unchanged pins due for a bleach maintenance pulse
+    size_t                             m_colorCount;          ///< Number of entries in m_colorPins
+    size_t                             m_bleachCount;         ///< Number of entries in m_bleachPins
+    size_t                             m_colorRefreshCount;   ///< Number of entries in m_colorRefreshPins
+    size_t                             m_bleachRefreshCount;  ///< Number of entries in m_bleachRefreshPins
+
+   public:
+    /**
+     * @brief Constructor
+     * @param config ECD configuration parameters
+     * @param pins Array of GPIO pin numbers for segments
+     * @param hal Hardware abstraction layer instance
+     */
+    explicit ECDDrivePassiveDelta(const ECDConfig_t* config, const std::array<int, SEGMENT_COUNT>* pins,
+                                  ynv::driver::HALBase* hal)
+        : ECDDriveBase<SEGMENT_COUNT>(config, pins, hal),
+          m_driven({}),
+          m_lastDriveUs({}),
+          m_updatesSinceDriven({}),
+          m_colorPins({}),
+          m_bleachPins({}),
+          m_colorRefreshPins({}),
+          m_bleachRefreshPins({}),
+          m_colorCount(0),
+          m_bleachCount(0),
+          m_colorRefreshCount(0),
+          m_bleachRefreshCount(0)
+    {
+    }
+
+    ~ECDDrivePassiveDelta() = default;
+
+    using ECDDriveBase<SEGMENT_COUNT>::m_pins;
+    using ECDDriveBase<SEGMENT_COUNT>::m_config;
+    using ECDDriveBase<SEGMENT_COUNT>::m_hal;
+    using ECDDriveBase<SEGMENT_COUNT>::isAborted;
+    using ECDDriveBase<SEGMENT_COUNT>::writeSegments;
+
+    /**
+     * @brief Drive only the segments that changed state
+     * @param currentStates Current segment states (updated to match nextStates)
+     * @param nextStates Target segment states
+     *
+     * Segments are always driven on the first update, since their physical state is unknown.
+     */
+    void drive(std::array<bool, SEGMENT_COUNT>&       currentStates,
+               const std::array<bool, SEGMENT_COUNT>& nextStates) override
+    {
+        std::array<Group_t, SEGMENT_COUNT> groups {};
+
+        m_colorCount         = 0;
+        m_bleachCount        = 0;
+        m_colorRefreshCount  = 0;
+        m_bleachRefreshCount = 0;
+
+        // Categorize segments, each group shares one common voltage
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            if (!m_driven[i] || currentStates[i] != nextStates[i])
+            {  // Full coloring or bleaching pulse
+                if (nextStates[i])
+                {
+                    m_colorPins[m_colorCount++] = (*m_pins)[i];
+                }
+                else
+                {
+                    m_bleachPins[m_bleachCount++] = (*m_pins)[i];
+                }
+                currentStates[i] = nextStates[i];
+                groups[i]        = nextStates[i] ? GROUP_COLOR : GROUP_BLEACH;
+            }
+            else if (maintenanceDue(i))
+            {  // Low-duty refresh pulse to keep the current state
+                if (currentStates[i])
+                {
+                    m_colorRefreshPins[m_colorRefreshCount++] = (*m_pins)[i];
+                }
+                else
+                {
+                    m_bleachRefreshPins[m_bleachRefreshCount++] = (*m_pins)[i];
+                }
+                groups[i] = currentStates[i] ? GROUP_COLOR_REFRESH : GROUP_BLEACH_REFRESH;
+            }
+        }
+
+        // Pulse the groups in order, an abort skips the remaining groups
+        Group_t last = pulseStates();
+        if (last == GROUP_BLEACH && !isAborted())
+        {
+            pulseGroup(GROUP_COLOR_REFRESH);
+            last = GROUP_COLOR_REFRESH;
+        }
+        if (last == GROUP_COLOR_REFRESH && !isAborted())
+        {
+            pulseGroup(GROUP_BLEACH_REFRESH);
+            last = GROUP_BLEACH_REFRESH;
+        }
+
+        // Update the maintenance schedule
+        int64_t now = m_hal->micros();
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            if (groups[i] > last && (groups[i] == GROUP_COLOR || groups[i] == GROUP_BLEACH))
+            {
+                m_driven[i] = false;  // skipped state change, drive on the next update
+            }
+
+            if (groups[i] != GROUP_NONE && groups[i] <= last)
+            {
+                m_driven[i]             = true;
+                m_lastDriveUs[i]        = now;
+                m_updatesSinceDriven[i] = 0;
+            }
+            else
+            {
+                m_updatesSinceDriven[i]++;
+            }
+        }
+    }
+
+   protected:
+    /**
+     * @brief Pulse the state changes of the update, coloring before bleaching
+     * @return Last group completed before an abort (GROUP_NONE, GROUP_COLOR or GROUP_BLEACH)
+     */
+    virtual Group_t pulseStates()
+    {
+        if (isAborted())
+        {
+            return GROUP_NONE;
+        }
+        pulseGroup(GROUP_COLOR);
+        if (isAborted())
+        {
+            return GROUP_COLOR;
+        }
+        pulseGroup(GROUP_BLEACH);
+        return GROUP_BLEACH;
+    }
+
+   private:
+    /** @brief Pulse all segments of a group */
+    void pulseGroup(Group_t group)
+    {
+        switch (group)
+        {
+            case GROUP_COLOR:
+                writeSegments(m_colorPins.data(), m_colorCount, true, m_config->coloringTime,
+                              (m_config->maxAnalogValue - m_config->coloringVoltage), false);
+                break;
+            case GROUP_BLEACH:
+                writeSegments(m_bleachPins.data(), m_bleachCount, false, m_config->bleachingTime,
+                              m_config->bleachingVoltage, false);
+                break;
+            case GROUP_COLOR_REFRESH:
+                writeSegments(m_colorRefreshPins.data(), m_colorRefreshCount, true, m_config->refreshColorPulseTime,
+                              (m_config->maxAnalogValue - m_config->refreshColoringVoltage), true);
+                break;
+            case GROUP_BLEACH_REFRESH:
+                writeSegments(m_bleachRefreshPins.data(), m_bleachRefreshCount, false, m_config->refreshBleachPulseTime,
+                              m_config->refreshBleachingVoltage, true);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /**
+     * @brief Check the maintenance schedule of an unchanged segment
+     * @param i Segment index
+     * @return true if the segment needs a maintenance pulse in this update
+     */
+    bool maintenanceDue(int i)
+    {
+        if (m_config->maintenanceUpdates > 0 && (m_updatesSinceDriven[i] + 1) >= m_config->maintenanceUpdates)
+        {
+            return true;
+        }
+        if (m_config->maintenanceIntervalMs > 0 &&
+            (m_hal->micros() - m_lastDriveUs[i]) >= (int64_t)m_config->maintenanceIntervalMs * 1000)
+        {
+            return true;
+        }
+        return false;
+    }
+};
+}  // namespace ecd
+}  // namespace ynv
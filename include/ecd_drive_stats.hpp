@@ -0,0 +1,71 @@
+/**
+ * @file ecd_drive_stats.hpp
+ * @brief Telemetry of ECD drive operations
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace ynv
+{
+namespace ecd
+{
+
+/**
+ * @brief Long-term health of a single segment, learned by the active driver and kept in NVS
+ *
+ * The layout is stored as a blob, changing it requires a new ECDSegmentHealth::VERSION.
+ */
+struct SegmentHealth_t
+{
+    uint32_t cycles;               ///< State changes over the lifetime of the segment
+    float    colorRefreshPulses;   ///< Rolling mean of refresh pulses per update while colored
+    float    bleachRefreshPulses;  ///< Rolling mean of refresh pulses per update while bleached
+    bool     failing;              ///< Needs too many refresh pulses, refresh is budgeted
+};
+
+/**
+ * @brief What one update did to a single segment
+ */
+struct SegmentStats_t
+{
+    uint16_t        pulses;         ///< Pulses in the last update, including refresh pulses
+    uint16_t        refreshPulses;  ///< Refresh and maintenance pulses in the last update
+    int32_t         charge;         ///< Segment voltage (analog units) x pulse time (ms), + color, - bleach
+    int16_t         lastAnalog;     ///< Open-circuit voltage read last (analog units), -1 if never read
+    float           refreshRate;    ///< Rolling mean of refresh pulses per update
+    SegmentHealth_t health;         ///< Health record (active driving, zero otherwise)
+};
+
+/**
+ * @brief Telemetry of the last update and rolling aggregates over recent updates
+ *
+ * Filled by the driver at the end of every drive(). Reading it does not touch the hardware, so it can
+ * be polled from any task.
+ */
+struct DriveStats_t
+{
+    static constexpr int MAX_SEGMENTS   = 15;  ///< Largest EvalKit display
+    static constexpr int LATENCY_WINDOW = 64;  ///< Updates covered by the latency percentiles
+
+    // Last update
+    int     segmentCount;    ///< Valid entries in segments
+    int     colored;         ///< Segments switched to color
+    int     bleached;        ///< Segments switched to bleach
+    int     refreshRetries;  ///< Refresh iterations (active driving)
+    bool    timedOut;        ///< Refresh loop gave up after MAX_REFRESH_RETRIES
+    bool    aborted;         ///< Superseded by a newer update before completion
+    int64_t durationUs;      ///< Time spent in drive() (HAL time base)
+
+    std::array<SegmentStats_t, MAX_SEGMENTS> segments;  ///< Per-segment results
+
+    // Rolling aggregates
+    uint32_t updates;   ///< drive() calls since start
+    uint32_t timeouts;  ///< Updates with timedOut set since start
+    int64_t  p50Us;     ///< Median drive() time over the last LATENCY_WINDOW updates (computed when read)
+    int64_t  p99Us;     ///< 99th percentile drive() time over the last LATENCY_WINDOW updates (computed when read)
+};
+
+}  // namespace ecd
+}  // namespace ynv
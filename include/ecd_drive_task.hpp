@@ -0,0 +1,116 @@
+/**
+ * @file ecd_drive_task.hpp
+ * @brief Background drive task for asynchronous ECD updates
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace ynv
+{
+namespace ecd
+{
+
+class ECDBase;
+
+/**
+ * @brief Singleton task that runs ECD updates in the background
+ *
+ * ECDBase::updateAsync() queues a drive job here and returns immediately. The task drives one
+ * job at a time, like the shared multiplexer, in the order the displays were submitted. Every
+ * display has at most one pending job: a newer request of the display replaces its pending one,
+ * and a request with different target states aborts the running job of the same display at its
+ * next safe point, so the display never works through stale transitions. Jobs of other displays
+ * are never aborted or dropped.
+ */
+class ECDDriveTask
+{
+   public:
+    /** @brief Update completion callback type, called from the drive task */
+    typedef void (*UpdateCallback_f)(ECDBase* display);
+
+    static constexpr const char* TAG = "ECDDriveTask";
+
+    /** @brief Default task settings */
+    static constexpr uint32_t    DEFAULT_STACK_SIZE = 4096;
+    static constexpr UBaseType_t DEFAULT_PRIORITY   = 6;
+
+    /** @brief Displays that can have a pending job at the same time */
+    static constexpr size_t MAX_PENDING = 8;
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to drive task
+     */
+    static ECDDriveTask& getInstance()
+    {
+        static ECDDriveTask instance;
+        return instance;
+    }
+
+    /**
+     * @brief Create the drive task
+     * @param priority Task priority, above the task calling updateAsync()
+     * @param stackSize Task stack size in bytes
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be created
+     */
+    esp_err_t init(UBaseType_t priority = DEFAULT_PRIORITY, uint32_t stackSize = DEFAULT_STACK_SIZE);
+
+    /**
+     * @brief Queue a drive job
+     * @param display Display to drive (must outlive the job)
+     * @param cb Completion callback (nullptr for none)
+     * @param supersede Target states differ from the queued or running job of the display
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the task is not initialized, ESP_ERR_NO_MEM if
+     *         MAX_PENDING other displays already have a pending job
+     *
+     * Only the latest request of a display reports completion, its superseded requests are dropped silently.
+     */
+    esp_err_t submit(ECDBase* display, UpdateCallback_f cb, bool supersede);
+
+    /**
+     * @brief Check if a job is running or pending
+     * @return true if busy
+     */
+    bool isBusy();
+
+   private:
+    /** @brief Private constructor for singleton */
+    ECDDriveTask() : m_task(nullptr), m_pending(), m_pendingCount(0), m_running(nullptr), m_runningCb(nullptr) { }
+
+    ~ECDDriveTask()                              = default;
+    ECDDriveTask(const ECDDriveTask&)            = delete;
+    ECDDriveTask& operator=(const ECDDriveTask&) = delete;
+
+    /**
+     * @brief A queued drive job
+     */
+    struct Job_t
+    {
+        ECDBase*         display;  ///< Display to drive
+        UpdateCallback_f cb;       ///< Completion callback
+    };
+
+    TaskHandle_t                   m_task;          ///< Drive task handle
+    std::array<Job_t, MAX_PENDING> m_pending;       ///< Pending jobs in submit order, one per display
+    size_t                         m_pendingCount;  ///< Entries of m_pending in use
+    ECDBase*                       m_running;       ///< Display of the running job
+    UpdateCallback_f               m_runningCb;     ///< Callback of the running job
+
+    /** @brief Protects the job queue */
+    portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+    /** @brief Task entry point */
+    static void taskEntry(void* arg);
+
+    /** @brief Run jobs until no job is pending */
+    void run();
+};
+
+}  // namespace ecd
+}  // namespace ynv
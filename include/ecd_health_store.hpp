@@ -0,0 +1,73 @@
+/**
+ * @file ecd_health_store.hpp
+ * @brief NVS storage of the segment health records
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "esp_err.h"
+#include "nvs.h"
+
+namespace ynv
+{
+namespace ecd
+{
+
+/**
+ * @brief Keeps one segment health blob per display in the NVS namespace NAMESPACE
+ *
+ * The application initializes the NVS partition (nvs_flash_init) before the first load. Without it
+ * load() and save() fail and the health records live in RAM only.
+ */
+class ECDHealthStore
+{
+   public:
+    static constexpr const char* TAG       = "ECDHealthStore";
+    static constexpr const char* NAMESPACE = "ynv_health";
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the health store
+     */
+    static ECDHealthStore& getInstance()
+    {
+        static ECDHealthStore instance;
+        return instance;
+    }
+
+    /**
+     * @brief Read a blob
+     * @param key NVS key (at most 15 characters)
+     * @param data Destination
+     * @param size Expected blob size (bytes)
+     * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if there is none, ESP_ERR_INVALID_SIZE if the size differs
+     */
+    esp_err_t load(const char* key, void* data, size_t size);
+
+    /**
+     * @brief Write and commit a blob
+     * @param key NVS key (at most 15 characters)
+     * @param data Source
+     * @param size Blob size (bytes)
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t save(const char* key, const void* data, size_t size);
+
+   private:
+    /** @brief Private constructor for singleton */
+    ECDHealthStore() : m_handle(0), m_open(false) { }
+
+    ~ECDHealthStore()                                = default;
+    ECDHealthStore(const ECDHealthStore&)            = delete;
+    ECDHealthStore& operator=(const ECDHealthStore&) = delete;
+
+    /** @brief Open the namespace on first use */
+    esp_err_t open();
+
+    nvs_handle_t m_handle;  ///< Handle of NAMESPACE
+    bool         m_open;    ///< m_handle is valid
+};
+
+}  // namespace ecd
+}  // namespace ynv
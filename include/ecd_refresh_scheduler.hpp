@@ -0,0 +1,196 @@
+/**
+ * @file ecd_refresh_scheduler.hpp
+ * @brief Drift-predictive refresh scheduling for active ECD driving
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "ecd_drive_base.hpp"
+
+namespace ynv
+{
+namespace ecd
+{
+/**
+ * @brief Predicts per segment when its open-circuit voltage leaves the refresh window
+ * @tparam SEGMENT_COUNT Number of display segments
+ *
+ * Two reads of a segment without a pulse in between give its drift rate (ADC units per s, away
+ * from the refreshed state), filtered per segment. After every read the segment is scheduled for
+ * the next read at MARGIN_PCT of the time its voltage needs to drift to the outer limit of the
+ * window (refreshColorLimitLVoltage when colored, refreshBleachLimitHVoltage when bleached).
+ * Unchanged segments are only read and refreshed when they are due.
+ *
+ * A segment without a learned rate is probed: read on the next update, then at doubling intervals
+ * until it drifted at least MIN_DRIFT_DIVISOR-th of the window, which keeps ADC noise out of the rate.
+ * Segments that fall due together are spread over consecutive updates: at most MAX_DUE_PER_UPDATE
+ * are refreshed per update, the most overdue first. Segments predicted to have left the window
+ * already are refreshed regardless.
+ */
+template <int SEGMENT_COUNT>
+class ECDRefreshScheduler
+{
+   private:
+    /**
+     * @brief Schedule of one segment
+     */
+    struct Segment_t
+    {
+        float   rate;       ///< Drift away from the refreshed state (ADC units/s, 0=unknown)
+        int     lastValue;  ///< Voltage read last
+        int64_t lastUs;     ///< Time of lastValue (HAL time base)
+        int64_t probeUs;    ///< Interval of the last probe read while the rate is unknown (us)
+        int64_t dueUs;      ///< Next read (HAL time base), 0=next update
+        int64_t leaveUs;    ///< Predicted time the voltage leaves the window (HAL time base)
+        bool    valid;      ///< lastValue shows the drift alone, no pulse since
+    };
+
+    std::array<Segment_t, SEGMENT_COUNT> m_segments;  ///< Schedule per segment
+    std::array<bool, SEGMENT_COUNT>      m_due;       ///< Selected for refresh by the running update
+    const ECDConfig_t*                   m_config;    ///< ECD configuration
+
+   public:
+    /** @brief Read a segment after this share of its predicted time in the window (%) */
+    static constexpr int MARGIN_PCT = 50;
+
+    /** @brief Drift smaller than window / MIN_DRIFT_DIVISOR does not update the rate */
+    static constexpr int MIN_DRIFT_DIVISOR = 8;
+
+    /** @brief Longest time between two reads of a segment (ms) */
+    static constexpr int64_t MAX_INTERVAL_MS = 120000;
+
+    /** @brief Most segments refreshed by one update */
+    static constexpr int MAX_DUE_PER_UPDATE = 4;
+
+    /** @brief Weight of a new rate observation (EWMA) */
+    static constexpr float RATE_WEIGHT = 0.5f;
+
+    /**
+     * @brief Constructor
+     * @param config ECD configuration parameters
+     */
+    explicit ECDRefreshScheduler(const ECDConfig_t* config) : m_segments(), m_due(), m_config(config) { }
+
+    /**
+     * @brief Select the unchanged segments to refresh in this update, called at the start of every drive()
+     * @param nowUs Current time (HAL time base)
+     * @param currentStates Current segment states
+     * @param nextStates Target segment states
+     */
+    void begin(int64_t nowUs, const std::array<bool, SEGMENT_COUNT>& currentStates,
+               const std::array<bool, SEGMENT_COUNT>& nextStates)
+    {
+        int count {0};
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            m_due[i] = (currentStates[i] == nextStates[i] && m_segments[i].leaveUs <= nowUs);
+            count += m_due[i] ? 1 : 0;
+        }
+
+        for (; count < MAX_DUE_PER_UPDATE; ++count)
+        {
+            int next {-1};
+            for (int i = 0; i < SEGMENT_COUNT; ++i)
+            {
+                if (m_due[i] || currentStates[i] != nextStates[i] || m_segments[i].dueUs > nowUs)
+                {
+                    continue;
+                }
+                if (next < 0 || m_segments[i].dueUs < m_segments[next].dueUs)
+                {
+                    next = i;
+                }
+            }
+            if (next < 0)
+            {
+                break;
+            }
+            m_due[next] = true;
+        }
+    }
+
+    /**
+     * @brief Check if a segment is refreshed by the running update
+     * @param index Segment index
+     * @return true if selected by begin()
+     */
+    bool isDue(int index) const { return m_due[index]; }
+
+    /**
+     * @brief A segment changes state, its drift has to be observed again from the next update
+     * @param index Segment index
+     */
+    void switched(int index)
+    {
+        Segment_t& segment = m_segments[index];
+        segment.dueUs      = 0;
+        segment.leaveUs    = 0;
+        segment.probeUs    = 0;
+        segment.valid      = false;
+    }
+
+    /**
+     * @brief A refresh pulse was queued for a segment
+     * @param index Segment index
+     */
+    void pulsed(int index)
+    {
+        m_segments[index].dueUs   = 0;
+        m_segments[index].leaveUs = 0;
+        m_segments[index].valid   = false;
+    }
+
+    /**
+     * @brief Learn from a read of a segment and schedule its next read
+     * @param index Segment index
+     * @param value Voltage read (ADC units)
+     * @param nowUs Time of the read (HAL time base)
+     * @param color Refreshed state (true=color, false=bleach)
+     */
+    void read(int index, int value, int64_t nowUs, bool color)
+    {
+        Segment_t& segment = m_segments[index];
+
+        int window = color ? (m_config->refreshColorLimitHVoltage - m_config->refreshColorLimitLVoltage)
+                           : (m_config->refreshBleachLimitHVoltage - m_config->refreshBleachLimitLVoltage);
+
+        if (segment.valid && nowUs > segment.lastUs)
+        {
+            int64_t elapsedUs = nowUs - segment.lastUs;
+            int     drift     = color ? (segment.lastValue - value) : (value - segment.lastValue);
+            if (drift >= window / MIN_DRIFT_DIVISOR)
+            {
+                float seen   = (float)drift * 1000000 / elapsedUs;
+                segment.rate = (segment.rate > 0) ? segment.rate + (seen - segment.rate) * RATE_WEIGHT : seen;
+            }
+            else
+            {
+                segment.probeUs = std::max(segment.probeUs, elapsedUs);
+            }
+        }
+
+        // Distance to the outer limit of the window
+        int distance = color ? (value - m_config->refreshColorLimitLVoltage)
+                             : (m_config->refreshBleachLimitHVoltage - value);
+
+        int64_t leaveUs {0};
+        int64_t intervalUs {0};
+        if (distance > 0)
+        {
+            leaveUs    = (segment.rate > 0) ? (int64_t)(distance / segment.rate * 1000000) : segment.probeUs * 2;
+            intervalUs = (segment.rate > 0) ? leaveUs * MARGIN_PCT / 100 : leaveUs;
+            intervalUs = std::min(intervalUs, MAX_INTERVAL_MS * 1000);
+        }
+
+        segment.lastValue = value;
+        segment.lastUs    = nowUs;
+        segment.dueUs     = nowUs + intervalUs;
+        segment.leaveUs   = nowUs + std::max(leaveUs, intervalUs);
+        segment.valid     = true;
+    }
+};
+}  // namespace ecd
+}  // namespace ynv
@@ -0,0 +1,311 @@
+/**
+ * @file ecd_segment_health.hpp
+ * @brief Per-segment degradation tracking for active ECD driving
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "ecd_drive_base.hpp"
+#include "ecd_health_store.hpp"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+namespace ynv
+{
+namespace ecd
+{
+/**
+ * @brief Learns per segment how hard it is to keep, and whether it is wearing out
+ * @tparam SEGMENT_COUNT Number of display segments
+ *
+ * Every update the refresh pulses a segment needed to stay inside its refresh window are folded into
+ * a rolling mean per state, and state changes into the switching cycle count. The record survives resets
+ * in NVS: a completed update only marks it due, the application writes it with save() outside drive().
+ *
+ * From it the driver derives two budgets:
+ * - a segment that needs more refresh pulses than the display average gets a longer state pulse, so it
+ *   lands closer to its window right away instead of being topped up by the following updates.
+ * - a segment that needs FAILING_REFRESH_PULSES or more is flagged as failing and gets at most
+ *   FAILING_REFRESH_BUDGET refresh pulses per update, it no longer holds the whole display in the
+ *   refresh loop until MAX_REFRESH_RETRIES.
+ */
+template <int SEGMENT_COUNT>
+class ECDSegmentHealth
+{
+   private:
+    /**
+     * @brief Observations of one segment within the running update
+     */
+    struct Segment_t
+    {
+        int  pulses;   ///< Refresh pulses in the running update
+        bool refresh;  ///< Kept in its state by the running update
+        bool color;    ///< Refreshed state
+        bool reached;  ///< Reached its refresh window
+    };
+
+    /**
+     * @brief Blob stored in NVS
+     */
+    struct Record_t
+    {
+        uint32_t                                   version;   ///< VERSION
+        std::array<SegmentHealth_t, SEGMENT_COUNT> segments;  ///< Health per segment
+    };
+
+    Record_t                             m_record;    ///< Learned health
+    Record_t                             m_saved;     ///< Record of the last completed update, written by save()
+    std::array<Segment_t, SEGMENT_COUNT> m_segments;  ///< Observations of the running update
+    const ECDConfig_t*                   m_config;    ///< ECD configuration
+    const char*                          m_key;       ///< NVS key, nullptr if not persisted
+    int                                  m_unsaved;   ///< Updates since the record was last marked due
+    bool                                 m_saveDue;   ///< m_saved should be written to NVS
+
+    /** @brief Protects m_saved and m_saveDue between the drive task and save() */
+    mutable portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+   public:
+    static constexpr const char* TAG = "ECDHealth";
+
+    /** @brief Layout version of the NVS blob */
+    static constexpr uint32_t VERSION = 2;
+
+    /** @brief Weight of a new observation (EWMA) */
+    static constexpr float WEIGHT = 1.0f / 16;
+
+    /** @brief Rolling mean of refresh pulses per update from which a segment is failing */
+    static constexpr float FAILING_REFRESH_PULSES = 8.0f;
+
+    /** @brief A failing segment recovers below this rolling mean */
+    static constexpr float RECOVERED_REFRESH_PULSES = FAILING_REFRESH_PULSES / 2;
+
+    /** @brief Refresh pulses per update a failing segment gets */
+    static constexpr int FAILING_REFRESH_BUDGET = 2;
+
+    /** @brief Longest pre-compensation of a state pulse (% of the configured pulse time) */
+    static constexpr int MAX_COMPENSATION_PCT = 50;
+
+    /** @brief Updates after which the record is due for saving to NVS, limits flash wear */
+    static constexpr int SAVE_INTERVAL_UPDATES = 1000;
+
+    /**
+     * @brief Constructor
+     * @param config ECD configuration parameters
+     */
+    explicit ECDSegmentHealth(const ECDConfig_t* config)
+        : m_record(), m_saved(), m_segments(), m_config(config), m_key(nullptr), m_unsaved(0), m_saveDue(false)
+    {
+        m_record.version = VERSION;
+        m_saved.version  = VERSION;
+    }
+
+    /**
+     * @brief Restore the record from NVS and mark it due for saving there from now on
+     * @param key NVS key (at most 15 characters, must outlive this object)
+     * @return ESP_OK on success, error code otherwise (the record starts empty)
+     */
+    esp_err_t load(const char* key)
+    {
+        m_key = key;
+
+        Record_t  record;
+        esp_err_t err = ECDHealthStore::getInstance().load(key, &record, sizeof(record));
+        if (err == ESP_OK && record.version != VERSION)
+        {
+            err = ESP_ERR_INVALID_VERSION;
+        }
+        if (err != ESP_OK)
+        {
+            ESP_LOGI(TAG, "No health record %s (%s), starting empty", key, esp_err_to_name(err));
+            return err;
+        }
+        m_record = record;
+        taskENTER_CRITICAL(&m_lock);
+        m_saved = record;
+        taskEXIT_CRITICAL(&m_lock);
+        return ESP_OK;
+    }
+
+    /**
+     * @brief Write the record of the last completed update to NVS
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if load() was not called, NVS error otherwise (the
+     *         record stays due)
+     *
+     * Blocks for the NVS write and commit, call it from the application, not from the drive path. Safe
+     * while an update runs.
+     */
+    esp_err_t save()
+    {
+        if (m_key == nullptr)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        taskENTER_CRITICAL(&m_lock);
+        Record_t record = m_saved;
+        m_saveDue       = false;
+        taskEXIT_CRITICAL(&m_lock);
+
+        esp_err_t err = ECDHealthStore::getInstance().save(m_key, &record, sizeof(record));
+        if (err != ESP_OK)
+        {
+            taskENTER_CRITICAL(&m_lock);
+            m_saveDue = true;  // try again with the next save()
+            taskEXIT_CRITICAL(&m_lock);
+        }
+        return err;
+    }
+
+    /**
+     * @brief Check if the record should be written to NVS
+     * @return true if the save interval elapsed or a segment changed its failing flag since the last save()
+     */
+    bool isSaveDue() const
+    {
+        taskENTER_CRITICAL(&m_lock);
+        bool due = m_saveDue;
+        taskEXIT_CRITICAL(&m_lock);
+        return due;
+    }
+
+    /** @brief Start observing an update, called at the start of every drive() */
+    void begin()
+    {
+        for (auto& segment : m_segments)
+        {
+            segment.pulses  = 0;
+            segment.refresh = false;
+            segment.reached = false;
+        }
+    }
+
+    /**
+     * @brief A segment changes state in this update
+     * @param index Segment index
+     */
+    void switched(int index) { m_record.segments[index].cycles++; }
+
+    /**
+     * @brief A segment keeps its state in this update and will be refreshed
+     * @param index Segment index
+     * @param color Refreshed state (true=color, false=bleach)
+     */
+    void refreshing(int index, bool color)
+    {
+        m_segments[index].refresh = true;
+        m_segments[index].color   = color;
+    }
+
+    /**
+     * @brief A refreshed segment reached its refresh window
+     * @param index Segment index
+     */
+    void reached(int index) { m_segments[index].reached = true; }
+
+    /**
+     * @brief A refresh pulse was queued for a segment
+     * @param index Segment index
+     */
+    void pulsed(int index) { m_segments[index].pulses++; }
+
+    /**
+     * @brief Check if a segment may get another refresh pulse in this update
+     * @param index Segment index
+     * @return true if the segment is within its refresh budget
+     */
+    bool canRefresh(int index) const
+    {
+        return !m_record.segments[index].failing || m_segments[index].pulses < FAILING_REFRESH_BUDGET;
+    }
+
+    /**
+     * @brief Fold the observations of the update into the record, called at the end of a completed drive()
+     *
+     * Copies the record for save() and marks it due when the interval elapsed or a segment changed its
+     * failing flag, it is not written here.
+     */
+    void end()
+    {
+        bool changed {false};
+        for (int i = 0; i < SEGMENT_COUNT; ++i)
+        {
+            const Segment_t& segment = m_segments[i];
+            if (!segment.refresh)
+            {
+                continue;
+            }
+
+            // A segment that gave up (budget or timeout) needed at least as much as a failing one
+            SegmentHealth_t& health = m_record.segments[i];
+            float            seen   = segment.pulses;
+            if (!segment.reached)
+            {
+                seen = std::max(seen, FAILING_REFRESH_PULSES);
+            }
+            float& mean  = segment.color ? health.colorRefreshPulses : health.bleachRefreshPulses;
+            mean        += (seen - mean) * WEIGHT;
+
+            float worst   = std::max(health.colorRefreshPulses, health.bleachRefreshPulses);
+            bool  failing = health.failing ? (worst >= RECOVERED_REFRESH_PULSES) : (worst >= FAILING_REFRESH_PULSES);
+            if (failing != health.failing)
+            {
+                health.failing = failing;
+                changed        = true;
+                ESP_LOGW(TAG, "Segment %d %s (%.1f refresh pulses per update)", i, failing ? "is failing" : "recovered",
+                         (double)worst);
+            }
+        }
+
+        m_unsaved++;
+        bool due = m_key != nullptr && (changed || m_unsaved >= SAVE_INTERVAL_UPDATES);
+        if (due)
+        {
+            m_unsaved = 0;
+        }
+
+        taskENTER_CRITICAL(&m_lock);
+        m_saved    = m_record;
+        m_saveDue |= due;
+        taskEXIT_CRITICAL(&m_lock);
+    }
+
+    /**
+     * @brief State pulse width pre-compensated for a segment that needs more refresh than the others
+     * @param index Segment index
+     * @param color Target state (true=color, false=bleach)
+     * @return Pulse width (ms)
+     */
+    int pulseTime(int index, bool color) const
+    {
+        int base    = color ? m_config->coloringTime : m_config->bleachingTime;
+        int refresh = color ? m_config->refreshColorPulseTime : m_config->refreshBleachPulseTime;
+
+        // the refresh the segment typically needs after reaching this state, on top of the display average
+        float mean {0};
+        for (const auto& health : m_record.segments)
+        {
+            mean += color ? health.colorRefreshPulses : health.bleachRefreshPulses;
+        }
+        mean /= SEGMENT_COUNT;
+
+        const SegmentHealth_t& health = m_record.segments[index];
+        float excess = (color ? health.colorRefreshPulses : health.bleachRefreshPulses) - mean;
+        if (health.failing || excess <= 0)
+        {
+            return base;  // a failing segment does not get more charge that it cannot hold
+        }
+        return base + std::min((int)(excess * refresh), base * MAX_COMPENSATION_PCT / 100);
+    }
+
+    /**
+     * @brief Get the health record of a segment
+     * @param index Segment index
+     * @return Health record
+     */
+    const SegmentHealth_t& get(int index) const { return m_record.segments[index]; }
+};
+}  // namespace ecd
+}  // namespace ynv
@@ -60,6 +60,9 @@ class EvalkitAnims
 
     /**
      * @brief Select and start animation on specified display
+     *
+     * State changes and transitions of the animation are published on the EventBus with the display
+     * type as source.
      * @param disp Display type to animate
      * @param anim Animation type to run
      * @return Selected animation type
@@ -78,14 +81,46 @@ class EvalkitAnims
      */
     bool isSelected() const { return m_currentAnim != ANIM_CNT && m_anims[m_currentAnim] != nullptr; }
 
-    /** @brief Animation state change callback function type */
-    typedef void (*StateChangeCallback_f)(AnimBase::State_t);
+    /**
+     * @brief Drive displays in the background (ECDDriveTask) instead of blocking in update()
+     * @param async true to use asynchronous display updates
+     * @note The drive task must be initialized (ECDDriveTask::init) before selecting an animation
+     */
+    void setAsyncUpdate(bool async)
+    {
+        m_asyncUpdate = async;
+        if (isSelected())
+        {
+            m_anims[m_currentAnim]->setAsyncUpdate(async);
+        }
+    }
 
     /**
-     * @brief Register callback for animation state changes
-     * @param cb Callback function
+     * @brief Set the time between two transitions of an animation type
+     * @param anim Animation type
+     * @param rateMs Transition rate (ms)
      */
-    void registerStateChangeCallback(StateChangeCallback_f cb) { m_stateChangeCallback = cb; }
+    void setTransitionRate(Anim_t anim, uint32_t rateMs)
+    {
+        m_transitionRates[anim] = rateMs;
+        if (anim == m_currentAnim && isSelected())
+        {
+            m_anims[m_currentAnim]->setTransitionRate(rateMs);
+        }
+    }
+
+    /**
+     * @brief Update the display between transitions and while paused (AnimBase::setRefreshInterval)
+     * @param intervalMs Refresh interval (ms), 0 for none
+     */
+    void setRefreshInterval(uint32_t intervalMs)
+    {
+        m_refreshInterval = intervalMs;
+        if (isSelected())
+        {
+            m_anims[m_currentAnim]->setRefreshInterval(intervalMs);
+        }
+    }
 
     /** @brief Mapping from animation enum to display name */
     inline static const std::map<Anim_t, std::string> m_animNames = {{ANIM_TOGGLE, ANIM_NAME_TOGGLE},
@@ -99,19 +134,23 @@ class EvalkitAnims
     EvalkitAnims()
         : m_anims({}),
           m_currentAnim(ANIM_CNT),
-          m_stateChangeCallback(nullptr),
-          m_dispIndex(ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t::EVALKIT_DISP_CNT)
+          m_dispIndex(ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t::EVALKIT_DISP_CNT),
+          m_asyncUpdate(false),
+          m_refreshInterval(0)
     {
+        m_transitionRates.fill(AnimBase::DEFAULT_TRANSITION_RATE_MS);
     }
 
     ~EvalkitAnims()                              = default;
     EvalkitAnims(const EvalkitAnims&)            = delete;
     EvalkitAnims& operator=(const EvalkitAnims&) = delete;
 
-    std::array<std::unique_ptr<AnimBase>, ANIM_CNT> m_anims;                ///< Animation instances
-    Anim_t                                          m_currentAnim;          ///< Currently selected animation
-    StateChangeCallback_f                           m_stateChangeCallback;  ///< State change callback
-    ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t  m_dispIndex;            ///< Current display type
+    std::array<std::unique_ptr<AnimBase>, ANIM_CNT> m_anims;            ///< Animation instances
+    Anim_t                                          m_currentAnim;      ///< Currently selected animation
+    ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t  m_dispIndex;        ///< Current display type
+    bool                                            m_asyncUpdate;      ///< Use asynchronous display updates
+    std::array<uint32_t, ANIM_CNT>                  m_transitionRates;  ///< Transition rate per type (ms)
+    uint32_t                                        m_refreshInterval;  ///< Display refresh interval (ms)
 
     /**
      * @brief Initialize animations for specified display type
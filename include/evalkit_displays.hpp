@@ -5,7 +5,6 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
 #include <cassert>
 #include <functional>
@@ -20,6 +19,7 @@
 #include "disp_single_segment.hpp"
 #include "disp_test.hpp"
 #include "ecd.hpp"
+#include "esp_log.h"
 
 namespace ynv
 {
@@ -35,6 +35,8 @@ namespace ecd
 class EvalkitDisplays
 {
    public:
+    static constexpr const char* TAG = "EvalkitDisplays";
+
     /**
      * @brief Supported EvalKit display types
      */
@@ -84,8 +86,21 @@ class EvalkitDisplays
             std::make_shared<DispSignedNumber>(&DispSignedNumber::PINS, m_appConfig);
         m_displays[EVALKIT_DISP_TEST] = std::make_shared<DispTest>(&DispTest::PINS, m_appConfig);
 
-        // Initialize all displays
-        std::for_each(m_displays.begin(), m_displays.end(), [](auto& d) { d->init(); });
+        // Initialize all displays, their drive events carry the display index
+        for (int i = 0; i < EVALKIT_DISP_CNT; ++i)
+        {
+            m_displays[i]->init();
+            m_displays[i]->setEventSource((uint8_t)i);
+        }
+
+        // Restore the segment health learned before the last reset
+        if (m_appConfig->activeDriving && m_appConfig->segmentHealth)
+        {
+            for (int i = 0; i < EVALKIT_DISP_CNT; ++i)
+            {
+                (void)m_displays[i]->loadHealth(HEALTH_KEYS[i]);
+            }
+        }
 
         // Set default display
         m_dispIndex  = EVALKIT_DISP_TEST;
@@ -122,7 +137,37 @@ class EvalkitDisplays
         return m_displayPtr;
     }
 
+    /**
+     * @brief Write the segment health records that are due to NVS
+     * @return ESP_OK if all due records were saved, the error of the last failed one otherwise
+     *
+     * Blocks for the NVS writes, call it periodically from the application task or another low priority
+     * task. A record that failed stays due and is written by the next call.
+     */
+    esp_err_t saveHealth()
+    {
+        esp_err_t result = ESP_OK;
+        for (int i = 0; i < EVALKIT_DISP_CNT; ++i)
+        {
+            if (m_displays[i] == nullptr || !m_displays[i]->isHealthSaveDue())
+            {
+                continue;
+            }
+            esp_err_t err = m_displays[i]->saveHealth();
+            if (err != ESP_OK)
+            {
+                ESP_LOGE(TAG, "Failed to save health record %s: %s", HEALTH_KEYS[i], esp_err_to_name(err));
+                result = err;
+            }
+        }
+        return result;
+    }
+
    private:
+    /** @brief NVS keys of the segment health records, one per display type */
+    static constexpr const char* HEALTH_KEYS[EVALKIT_DISP_CNT] = {"single", "bar3", "bar7", "dot",
+                                                                  "decimal", "signed", "test"};
+
     /** @brief Private constructor for singleton */
     EvalkitDisplays() : m_displayPtr(nullptr), m_appConfig(nullptr) { }
 
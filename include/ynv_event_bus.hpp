@@ -0,0 +1,152 @@
+/**
+ * @file ynv_event_bus.hpp
+ * @brief Lock-free ring of animation and drive events for asynchronous subscribers
+ *
+ * Animations and drivers publish what happened (state changes, transitions, refresh timeouts) into a
+ * ring buffer instead of calling back into the application from their task. Every subscriber keeps its
+ * own read position and consumes the events in its own task, e.g. the GUI from an LVGL timer. Publishing
+ * never waits for a subscriber: a subscriber that falls more than CAPACITY events behind loses the oldest
+ * ones and is told how many.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace ynv
+{
+namespace driver
+{
+
+/**
+ * @brief Event types
+ */
+enum EventType_t : uint8_t
+{
+    EVENT_ANIM_STATE = 1,   ///< Animation state changed: source=display or lane, value=AnimBase::State_t
+    EVENT_ANIM_TRANSITION,  ///< Animation made a transition: source=display or lane, value=transitions since start
+    EVENT_REFRESH_TIMEOUT,  ///< Refresh loop gave up before all segments reached their window: source=display,
+                            ///< value=retries
+};
+
+/**
+ * @brief A single event
+ *
+ * The owner of the publisher picks the source: EvalkitAnims and EvalkitDisplays use the display index
+ * (EvalkitDisplays::ECDEvalkitDisplay_t), AnimEngine the lane index, unset sources are 0.
+ */
+struct Event_t
+{
+    uint32_t    timeUs;    ///< Time since boot (microseconds, wraps after ~71 minutes)
+    EventType_t type;      ///< Event type
+    uint8_t     source;    ///< Publisher, see AnimBase::setEventSource and ECDBase::setEventSource
+    uint16_t    reserved;  ///< Padding
+    int32_t     value;     ///< Event specific value
+};
+static_assert(sizeof(Event_t) == 12, "Event_t is copied as three words");
+
+/**
+ * @brief Read position of a subscriber
+ */
+struct Subscriber_t
+{
+    uint32_t cursor;   ///< Next event to read
+    uint32_t dropped;  ///< Events overwritten before they were read since subscribe()
+};
+
+/**
+ * @brief Singleton multi-subscriber event ring
+ *
+ * publish() claims a slot with one atomic increment and marks it with a sequence number while writing
+ * (seqlock), it takes no lock and never blocks, so it can be called from the anim, lane and drive tasks.
+ * poll() copies a slot and checks the sequence number afterwards: an event rewritten while it was copied
+ * is skipped and counted as dropped, as are events the writers lapped.
+ *
+ * Subscribers poll when they like, or pass a task to subscribe() that is notified (xTaskNotifyGive) on
+ * every publish and waits with ulTaskNotifyTake.
+ */
+class EventBus
+{
+   public:
+    static constexpr const char* TAG = "ynv_event";
+
+    /** @brief Events kept, a power of two so that slots stay in order when the counters wrap */
+    static constexpr uint32_t CAPACITY = 32;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    /** @brief Most subscribers notified on publish */
+    static constexpr int MAX_NOTIFY = 4;
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the event bus
+     */
+    static EventBus& getInstance()
+    {
+        static EventBus instance;
+        return instance;
+    }
+
+    /**
+     * @brief Store an event with the current time and notify the waiting subscribers
+     * @param type Event type
+     * @param source Publisher
+     * @param value Event specific value
+     */
+    void publish(EventType_t type, uint8_t source, int32_t value);
+
+    /**
+     * @brief Start reading with the next event published
+     * @param sub Read position to initialize
+     * @param notify Task to notify on every publish (nullptr to poll only)
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if MAX_NOTIFY tasks are already notified
+     */
+    esp_err_t subscribe(Subscriber_t& sub, TaskHandle_t notify = nullptr);
+
+    /**
+     * @brief Read the next event of a subscriber
+     * @param sub Read position, advanced past the event
+     * @param event Destination
+     * @return true if an event was read, false if the subscriber is up to date
+     */
+    bool poll(Subscriber_t& sub, Event_t& event);
+
+    /**
+     * @brief Get the number of events published since boot
+     * @return Events published (wraps)
+     */
+    uint32_t published() const { return m_head.load(std::memory_order_relaxed); }
+
+   private:
+    /** @brief Words of an event */
+    static constexpr size_t EVENT_WORDS = sizeof(Event_t) / sizeof(uint32_t);
+
+    /**
+     * @brief One event of the ring
+     */
+    struct Slot_t
+    {
+        std::atomic<uint32_t> seq;                 ///< 2*ticket+1 while written, 2*ticket+2 when complete
+        std::atomic<uint32_t> words[EVENT_WORDS];  ///< Event_t
+    };
+
+    /** @brief Private constructor for singleton */
+    EventBus() : m_slots(), m_head(0), m_notify(), m_notifyCount(0) { }
+
+    ~EventBus()                          = default;
+    EventBus(const EventBus&)            = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    Slot_t                    m_slots[CAPACITY];     ///< Ring buffer
+    std::atomic<uint32_t>     m_head;                ///< Next ticket to publish
+    std::atomic<TaskHandle_t> m_notify[MAX_NOTIFY];  ///< Tasks notified on publish
+    std::atomic<int>          m_notifyCount;         ///< Entries of m_notify claimed
+};
+
+}  // namespace driver
+}  // namespace ynv
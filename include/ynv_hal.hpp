@@ -4,13 +4,28 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "app_config.hpp"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 namespace ynv
 {
 namespace driver
 {
+/**
+ * @brief A single segment pulse
+ */
+struct Pulse_t
+{
+    int     pin;         ///< Pin number
+    bool    high;        ///< Logic level (true=HIGH, false=LOW)
+    int32_t durationUs;  ///< Pulse width (microseconds)
+    int     common;      ///< Common electrode voltage (DAC units)
+};
+
 /**
  * @brief Abstract base class for hardware abstraction layer
  *
@@ -30,6 +45,56 @@ class HALBase
      */
     virtual esp_err_t digitalWrite(int pin, bool high, int delay = 10, int common = 0) = 0;
 
+    /**
+     * @brief Write the same digital value to a group of pins sharing one common voltage
+     * @param pins Pin numbers to write to
+     * @param count Number of pins
+     * @param high Logic level (true=HIGH, false=LOW)
+     * @param delay Duration to hold state per pin (milliseconds)
+     * @param common Common electrode voltage (DAC units)
+     * @return ESP_OK on success, first error code otherwise
+     *
+     * The default implementation pulses the pins one after the other with digitalWrite.
+     * Implementations can override it to set up the common electrode only once per group.
+     */
+    virtual esp_err_t digitalWriteMany(const int* pins, size_t count, bool high, int delay = 10, int common = 0)
+    {
+        esp_err_t ret = ESP_OK;
+        for (size_t i = 0; i < count; ++i)
+        {
+            esp_err_t err = digitalWrite(pins[i], high, delay, common);
+            if (ret == ESP_OK)
+            {
+                ret = err;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Run a queue of pulses back to back
+     * @param pulses Pulses in execution order
+     * @param count Number of pulses
+     * @return ESP_OK on success, first error code otherwise
+     *
+     * The default implementation rounds each pulse up to whole milliseconds and runs it with digitalWrite.
+     * Implementations with a hardware timer time the pulse width with microsecond precision.
+     */
+    virtual esp_err_t pulse(const Pulse_t* pulses, size_t count)
+    {
+        esp_err_t ret = ESP_OK;
+        for (size_t i = 0; i < count; ++i)
+        {
+            esp_err_t err = digitalWrite(pulses[i].pin, pulses[i].high, (pulses[i].durationUs + 999) / 1000,
+                                         pulses[i].common);
+            if (ret == ESP_OK)
+            {
+                ret = err;
+            }
+        }
+        return ret;
+    }
+
     /**
      * @brief Read analog value from a pin
      * @param pin Pin number to read from
@@ -37,6 +102,38 @@ class HALBase
      */
     virtual int analogRead(int pin) = 0;
 
+    /**
+     * @brief Read analog values from a group of pins
+     * @param pins Pin numbers to read from
+     * @param count Number of pins
+     * @param values Analog values (DAC units) per pin, <0 on error
+     * @return ESP_OK on success, first error code otherwise
+     *
+     * The default implementation reads the pins one after the other with analogRead.
+     * Implementations can override it to set up the analog path only once per group.
+     */
+    virtual esp_err_t analogReadMany(const int* pins, size_t count, int* values)
+    {
+        esp_err_t ret = ESP_OK;
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = analogRead(pins[i]);
+            if (values[i] < 0 && ret == ESP_OK)
+            {
+                ret = ESP_FAIL;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Get time base of the HAL
+     * @return Time since boot (microseconds)
+     *
+     * Drivers use this for time-based decisions, so that a simulated HAL can provide a virtual clock.
+     */
+    virtual int64_t micros() { return esp_timer_get_time(); }
+
     static constexpr const char* TAG = "HAL";
 
    protected:
@@ -0,0 +1,149 @@
+/**
+ * @file ynv_hal_batch.hpp
+ * @brief HAL proxy that merges the pulses and reads of several concurrently driven displays
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "ynv_hal.hpp"
+
+namespace ynv
+{
+namespace driver
+{
+/**
+ * @brief Shares one multiplexer and DAC between displays driven from different tasks
+ *
+ * Every update of a display driven concurrently is bracketed by attach() and detach(), which may be
+ * called from different tasks (e.g. a dispatcher attaches for the task it wakes). A pulse or read call
+ * blocks until every attached update waits in the HAL, then one of the callers runs the next step on
+ * the target HAL: the waiting reads of all displays in one scan (one mux setup), otherwise the shortest
+ * waiting pulse request. The pulses of a request stay together and in order, and its caller continues
+ * right after them. Of equally long requests the one starting at the level and common voltage the last
+ * one ended with goes first, so the two share one DAC write. Shortest first keeps the mean completion
+ * time of the displays at or below driving them one after the other.
+ *
+ * While no update is attached every call runs right away (a batch of one), so the proxy can stand in for
+ * the target HAL everywhere. The displays sharing the proxy must use disjoint segment pins.
+ */
+class BatchHAL : public HALBase
+{
+   public:
+    static constexpr const char* TAG = "BatchHAL";
+
+    /** @brief Displays that can wait in the HAL at the same time */
+    static constexpr int MAX_CLIENTS = 4;
+
+    /** @brief Pulses or pins per request, longer calls are split */
+    static constexpr size_t MAX_REQUEST_SIZE = 16;
+
+    /**
+     * @brief Batch counters
+     */
+    struct Stats_t
+    {
+        uint32_t batches;   ///< Steps run on the target HAL
+        uint32_t requests;  ///< Pulse and read requests run in them
+        uint32_t pulses;    ///< Pulses run
+        uint32_t reads;     ///< Pins read
+    };
+
+    /**
+     * @brief Constructor
+     * @param target HAL driving the hardware
+     */
+    explicit BatchHAL(HALBase* target);
+
+    ~BatchHAL() = default;
+
+    /**
+     * @brief Create the request semaphores
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if a semaphore could not be created
+     */
+    esp_err_t init();
+
+    /** @brief An update starts, batches wait for its requests until detach() */
+    void attach();
+
+    /** @brief An update finished */
+    void detach();
+
+    esp_err_t digitalWrite(int pin, bool high, int delay = 10, int common = 0) override;
+    esp_err_t digitalWriteMany(const int* pins, size_t count, bool high, int delay = 10, int common = 0) override;
+    esp_err_t pulse(const Pulse_t* pulses, size_t count) override;
+    int       analogRead(int pin) override;
+    esp_err_t analogReadMany(const int* pins, size_t count, int* values) override;
+
+    /** @brief Time base of the target HAL */
+    int64_t micros() override { return m_target->micros(); }
+
+    /**
+     * @brief Get the batch counters
+     * @param stats Copy of the counters
+     */
+    void getStats(Stats_t& stats);
+
+   private:
+    /**
+     * @brief A blocked pulse or read call
+     */
+    struct Request_t
+    {
+        const Pulse_t*    pulses;  ///< Pulses to run (pulse request)
+        const int*        pins;    ///< Pins to read (read request)
+        int*              values;  ///< Read values (read request)
+        size_t            count;   ///< Number of pulses or pins
+        esp_err_t         result;  ///< Result of the batch
+        bool              used;    ///< Slot holds a request
+        bool              taken;   ///< Request is part of the running step
+        SemaphoreHandle_t done;    ///< Given when the request has run
+    };
+
+    HALBase*                                        m_target;      ///< HAL driving the hardware
+    std::array<Request_t, MAX_CLIENTS>              m_requests;    ///< Request slots
+    std::array<int, MAX_CLIENTS>                    m_batch;       ///< Slots of the running step
+    std::array<int, MAX_CLIENTS * MAX_REQUEST_SIZE> m_pins;        ///< Merged read scan
+    std::array<int, MAX_CLIENTS * MAX_REQUEST_SIZE> m_values;      ///< Values of m_pins
+    int                                             m_attached;    ///< Attached tasks
+    int                                             m_waiting;     ///< Requests not yet in a step
+    bool                                            m_combining;   ///< A step is running
+    bool                                            m_lastHigh;    ///< Level of the last pulse run
+    int                                             m_lastCommon;  ///< Common voltage of the last pulse run (-1=none)
+    Stats_t                                         m_stats;       ///< Batch counters
+
+    /** @brief Protects the request slots and counters */
+    portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+    /**
+     * @brief Queue a request and block until it has run
+     * @param pulses Pulses to run, nullptr for a read request
+     * @param pins Pins to read, nullptr for a pulse request
+     * @param values Read values
+     * @param count Number of pulses or pins (at most MAX_REQUEST_SIZE)
+     * @return Result of the batch, ESP_ERR_INVALID_STATE if more than MAX_CLIENTS tasks call at once
+     */
+    esp_err_t submit(const Pulse_t* pulses, const int* pins, int* values, size_t count);
+
+    /** @brief Run steps while every attached task waits, called after a request or detach */
+    void combine();
+
+    /**
+     * @brief Choose the requests of the next step and mark them taken (called with m_lock held)
+     * @return Number of entries written to m_batch: all waiting reads, otherwise one pulse request
+     */
+    int select();
+
+    /**
+     * @brief Run the requests of m_batch on the target HAL and release their callers
+     * @param size Number of entries in m_batch
+     */
+    void execute(int size);
+};
+
+}  // namespace driver
+}  // namespace ynv
@@ -0,0 +1,142 @@
+/**
+ * @file ynv_trace.hpp
+ * @brief Compile-time gated binary trace of the HAL and driver hot path
+ *
+ * Logging every pulse and ADC read over the UART costs milliseconds per line and stretches the refresh
+ * loop it is meant to observe. With CONFIG_YNV_TRACE the YNV_TRACE_* macros store fixed-size binary
+ * records in a ring buffer instead, without formatting. YNV_TRACE_DUMP() writes the buffer to the log as
+ * hex lines, tools/ynv_trace_decode.py turns a captured log back into a table.
+ *
+ * Without CONFIG_YNV_TRACE the macros expand to nothing.
+ */
+#pragma once
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_YNV_TRACE
+
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+
+namespace ynv
+{
+namespace driver
+{
+/**
+ * @brief Trace event types
+ */
+enum TraceEvent_t : uint8_t
+{
+    TRACE_PULSE = 1,  ///< Segment pulse: pin, level, durationUs, common
+    TRACE_ADC_READ,   ///< Analog read: pin, value
+    TRACE_REFRESH,    ///< Refresh iteration of the active driver: value=attempt, durationUs=queued pulses
+    TRACE_ANIM_STEP,  ///< Animation step: value=step
+};
+
+/**
+ * @brief A single trace record, the layout is decoded by tools/ynv_trace_decode.py
+ */
+struct TraceRecord_t
+{
+    uint32_t timeUs;      ///< Time since boot (microseconds, wraps after ~71 minutes)
+    uint8_t  event;       ///< TraceEvent_t
+    uint8_t  pin;         ///< Pin number
+    uint8_t  level;       ///< Logic level (1=HIGH, 0=LOW)
+    uint8_t  reserved;    ///< Padding
+    int32_t  durationUs;  ///< Pulse width (microseconds)
+    uint16_t common;      ///< Common electrode voltage (DAC units)
+    uint16_t value;       ///< ADC value or event specific value
+};
+static_assert(sizeof(TraceRecord_t) == 16, "TraceRecord_t layout is shared with the host decoder");
+
+/**
+ * @brief Ring buffer of trace records
+ *
+ * When the buffer is full the oldest records are overwritten, dump() reports how many were lost.
+ * record() only copies 16 bytes under a spinlock, so it can be called from the drive and timer tasks.
+ */
+class Trace
+{
+   public:
+    static constexpr const char* TAG = "ynv_trace";
+
+    /** @brief Number of records kept */
+    static constexpr size_t CAPACITY = CONFIG_YNV_TRACE_CAPACITY;
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the trace buffer
+     */
+    static Trace& getInstance()
+    {
+        static Trace instance;
+        return instance;
+    }
+
+    /**
+     * @brief Store a record with the current time
+     * @param event Event type
+     * @param pin Pin number
+     * @param level Logic level
+     * @param durationUs Pulse width (microseconds)
+     * @param common Common electrode voltage (DAC units)
+     * @param value ADC value or event specific value
+     */
+    void record(TraceEvent_t event, int pin, bool level, int32_t durationUs, int common, int value);
+
+    /**
+     * @brief Copy the records, oldest first
+     * @param out Destination
+     * @param max Size of out (records)
+     * @return Number of records copied
+     */
+    size_t read(TraceRecord_t* out, size_t max);
+
+    /** @brief Write all records to the log as hex lines for tools/ynv_trace_decode.py and clear the buffer */
+    void dump();
+
+    /** @brief Drop all records */
+    void clear();
+
+   private:
+    /** @brief Private constructor for singleton */
+    Trace() : m_records(), m_head(0), m_count(0), m_dropped(0), m_dumping(false) { }
+
+    ~Trace()                       = default;
+    Trace(const Trace&)            = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    TraceRecord_t m_records[CAPACITY];  ///< Ring buffer
+    size_t        m_head;               ///< Next slot to write
+    size_t        m_count;              ///< Number of valid records
+    uint32_t      m_dropped;            ///< Records lost since the last dump
+    bool          m_dumping;            ///< dump() is writing the buffer, records are dropped
+
+    /** @brief Protects the ring buffer */
+    portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+}  // namespace driver
+}  // namespace ynv
+
+#define YNV_TRACE_PULSE(pin, level, durationUs, common) \
+    ::ynv::driver::Trace::getInstance().record(::ynv::driver::TRACE_PULSE, (pin), (level), (durationUs), (common), 0)
+#define YNV_TRACE_ADC_READ(pin, value) \
+    ::ynv::driver::Trace::getInstance().record(::ynv::driver::TRACE_ADC_READ, (pin), false, 0, 0, (value))
+#define YNV_TRACE_REFRESH(attempt, pulses) \
+    ::ynv::driver::Trace::getInstance().record(::ynv::driver::TRACE_REFRESH, 0, false, (pulses), 0, (attempt))
+#define YNV_TRACE_ANIM_STEP(step) \
+    ::ynv::driver::Trace::getInstance().record(::ynv::driver::TRACE_ANIM_STEP, 0, false, 0, 0, (step))
+#define YNV_TRACE_DUMP() ::ynv::driver::Trace::getInstance().dump()
+
+#else
+
+#define YNV_TRACE_PULSE(pin, level, durationUs, common) ((void)0)
+#define YNV_TRACE_ADC_READ(pin, value)                  ((void)0)
+#define YNV_TRACE_REFRESH(attempt, pulses)              ((void)0)
+#define YNV_TRACE_ANIM_STEP(step)                       ((void)0)
+#define YNV_TRACE_DUMP()                                ((void)0)
+
+#endif  // CONFIG_YNV_TRACE
@@ -0,0 +1,244 @@
+/**
+ * @file anim_engine.cpp
+ * @brief Concurrent animations on several displays sharing one multiplexer and DAC
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "anim_engine.hpp"
+
+#include <cstdint>
+
+#include "anim_scheduler.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace ynv
+{
+namespace anim
+{
+
+esp_err_t AnimEngine::init(ynv::driver::BatchHAL* hal, UBaseType_t priority, uint32_t stackSize)
+{
+    assert(hal != nullptr);
+
+    if (m_task != nullptr)
+    {
+        return ESP_OK;
+    }
+
+    m_hal       = hal;
+    m_priority  = priority;
+    m_stackSize = stackSize;
+
+    m_queue = xQueueCreate(QUEUE_LENGTH, sizeof(Event_t));
+    if (m_queue == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(taskEntry, "anim-engine", stackSize, this, priority + 1, &m_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create dispatcher task");
+        vQueueDelete(m_queue);
+        m_queue = nullptr;
+        m_task  = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t AnimEngine::add(AnimBase* anim, int& lane)
+{
+    assert(anim != nullptr);
+
+    if (m_task == nullptr)
+    {
+        ESP_LOGE(TAG, "Engine not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (m_laneCount >= MAX_LANES)
+    {
+        ESP_LOGE(TAG, "All %d lanes in use", MAX_LANES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    Lane_t& l    = m_lanes[m_laneCount];
+    l.anim       = anim;
+    l.deadlineUs = AnimBase::NO_DEADLINE;
+    l.busy       = false;
+    l.kick       = false;
+    l.commands   = xQueueCreate(QUEUE_LENGTH, sizeof(Command_t));
+    if (l.commands == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to create lane queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // the lane drives its display itself, the BatchHAL merges it with the other lanes
+    anim->setAsyncUpdate(false);
+    anim->setEventSource((uint8_t)m_laneCount);  // events of the lane carry its index
+
+    if (xTaskCreate(laneEntry, "anim-lane", m_stackSize, (void*)(intptr_t)m_laneCount, m_priority, &l.task) !=
+        pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create lane task");
+        vQueueDelete(l.commands);
+        l.commands = nullptr;
+        l.task     = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+
+    lane = m_laneCount++;
+    return ESP_OK;
+}
+
+esp_err_t AnimEngine::post(int lane, Command_t command)
+{
+    if (m_queue == nullptr)
+    {
+        ESP_LOGE(TAG, "Engine not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (lane < 0 || lane >= m_laneCount)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Event_t event = {
+        .lane       = lane,
+        .command    = command,
+        .deadlineUs = 0,
+    };
+    if (xQueueSend(m_queue, &event, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Event queue full, command %d for lane %d dropped", (int)command, lane);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+void AnimEngine::handle(const Event_t& event)
+{
+    Lane_t& lane = m_lanes[event.lane];
+
+    if (event.command == COMMAND_STEPPED)
+    {
+        lane.busy       = false;
+        lane.deadlineUs = lane.kick ? 0 : event.deadlineUs;
+        lane.kick       = false;
+        return;
+    }
+
+    // commands are applied by the lane itself, never while its animation steps
+    if (xQueueSend(lane.commands, &event.command, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Lane %d queue full, command %d dropped", event.lane, (int)event.command);
+        return;
+    }
+    lane.deadlineUs = 0;
+    lane.kick       = lane.busy;
+}
+
+void AnimEngine::taskEntry(void* arg)
+{
+    static_cast<AnimEngine*>(arg)->run();
+}
+
+void AnimEngine::laneEntry(void* arg)
+{
+    AnimEngine::getInstance().runLane((int)(intptr_t)arg);
+}
+
+void AnimEngine::run()
+{
+    std::array<bool, MAX_LANES> due;
+
+    while (true)
+    {
+        int64_t next {AnimBase::NO_DEADLINE};
+        for (int i = 0; i < m_laneCount; ++i)
+        {
+            if (!m_lanes[i].busy)
+            {
+                next = std::min(next, m_lanes[i].deadlineUs);
+            }
+        }
+
+        Event_t event;
+        if (xQueueReceive(m_queue, &event, AnimScheduler::ticksUntil(next)) == pdTRUE)
+        {
+            do
+            {
+                handle(event);
+            } while (xQueueReceive(m_queue, &event, 0) == pdTRUE);
+        }
+
+        // attach all due lanes before waking any, so that their first requests already meet in one batch
+        int64_t nowUs = esp_timer_get_time();
+        for (int i = 0; i < m_laneCount; ++i)
+        {
+            Lane_t& lane = m_lanes[i];
+            due[i]       = !lane.busy && lane.deadlineUs <= nowUs;
+            if (due[i])
+            {
+                lane.busy = true;
+                m_hal->attach();
+            }
+        }
+        for (int i = 0; i < m_laneCount; ++i)
+        {
+            if (due[i])
+            {
+                xTaskNotifyGive(m_lanes[i].task);
+            }
+        }
+    }
+}
+
+void AnimEngine::runLane(int index)
+{
+    Lane_t& lane = m_lanes[index];
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        Command_t command;
+        while (xQueueReceive(lane.commands, &command, 0) == pdTRUE)
+        {
+            switch (command)
+            {
+                case COMMAND_START:
+                    lane.anim->start();
+                    break;
+                case COMMAND_PAUSE:
+                    lane.anim->pause();
+                    break;
+                case COMMAND_RESUME:
+                    lane.anim->resume();
+                    break;
+                case COMMAND_ABORT:
+                    lane.anim->abort();
+                    break;
+                case COMMAND_CHANGE_STATE:
+                    (void)lane.anim->changeState();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        Event_t event = {
+            .lane       = index,
+            .command    = COMMAND_STEPPED,
+            .deadlineUs = lane.anim->step(esp_timer_get_time()),
+        };
+        m_hal->detach();
+        (void)xQueueSend(m_queue, &event, portMAX_DELAY);
+    }
+}
+
+}  // namespace anim
+}  // namespace ynv
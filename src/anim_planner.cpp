@@ -0,0 +1,115 @@
+/**
+ * @file anim_planner.cpp
+ * @brief Plans the segment switches of a timeline ahead of playing it
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "anim_planner.hpp"
+
+#include <vector>
+
+namespace ynv
+{
+namespace anim
+{
+
+namespace
+{
+/** @brief Segments a mask can hold */
+constexpr int MASK_BITS = 32;
+}  // namespace
+
+Timeline TransitionPlanner::plan(const Timeline& timeline, const Config_t& config)
+{
+    const size_t count = timeline.size();
+
+    std::vector<Frame_t> frames(count);
+    for (size_t k = 0; k < count; ++k)
+    {
+        frames[k] = timeline[k];
+    }
+
+    if (config.skipWindowMs > 0 && count > 1)
+    {
+        // runs of frames a segment spends in one state, as [first, end) frame indices
+        std::vector<size_t> starts;
+        starts.reserve(count);
+
+        for (int s = 0; s < MASK_BITS; ++s)
+        {
+            const uint32_t bit = 1u << s;
+
+            starts.clear();
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (k == 0 || ((frames[k].mask ^ frames[k - 1].mask) & bit) != 0)
+                {
+                    starts.push_back(k);
+                }
+            }
+
+            const size_t runs = starts.size();
+            if (runs < (timeline.loops() ? 2u : 3u))
+            {
+                continue;
+            }
+
+            // a run in the other state, short and with the same state on both sides, is never switched to
+            for (size_t j = 0; j < runs; ++j)
+            {
+                bool wraps = (j == 0 || j + 1 == runs);
+                if (wraps && !timeline.loops())
+                {
+                    continue;  // the first and the last state of a single run are shown
+                }
+
+                size_t   first = starts[j];
+                size_t   end   = (j + 1 < runs) ? starts[j + 1] : count;
+                uint32_t state = frames[first].mask & bit;
+                uint32_t prev  = frames[(first + count - 1) % count].mask & bit;
+                uint32_t next  = frames[end % count].mask & bit;
+                if (prev == state || next == state)
+                {
+                    continue;  // merged with a run kept before
+                }
+
+                uint64_t holdMs {0};
+                for (size_t k = first; k < end; ++k)
+                {
+                    holdMs += (frames[k].holdMs > 0) ? frames[k].holdMs : config.rateMs;
+                }
+                if (holdMs >= config.skipWindowMs)
+                {
+                    continue;
+                }
+
+                for (size_t k = first; k < end; ++k)
+                {
+                    frames[k].mask ^= bit;
+                }
+            }
+        }
+    }
+
+    return Timeline(std::move(frames), timeline.loops(), timeline.segments());
+}
+
+uint32_t TransitionPlanner::countSwitches(const Timeline& timeline)
+{
+    const size_t count = timeline.size();
+
+    uint32_t switches {0};
+    for (size_t k = 1; k < count; ++k)
+    {
+        switches += __builtin_popcount(timeline[k].mask ^ timeline[k - 1].mask);
+    }
+    if (timeline.loops() && count > 1)
+    {
+        switches += __builtin_popcount(timeline[0].mask ^ timeline[count - 1].mask);
+    }
+    return switches;
+}
+
+}  // namespace anim
+}  // namespace ynv
@@ -0,0 +1,145 @@
+/**
+ * @file anim_scheduler.cpp
+ * @brief Event-driven scheduler task for EvalKit animations
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "anim_scheduler.hpp"
+
+#include "esp_log.h"
+
+namespace ynv
+{
+namespace anim
+{
+
+esp_err_t AnimScheduler::init(UBaseType_t priority, uint32_t stackSize)
+{
+    if (m_task != nullptr)
+    {
+        return ESP_OK;
+    }
+
+    m_queue = xQueueCreate(QUEUE_LENGTH, sizeof(Event_t));
+    if (m_queue == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(taskEntry, "anim-sched", stackSize, this, priority, &m_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create scheduler task");
+        vQueueDelete(m_queue);
+        m_queue = nullptr;
+        m_task  = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t AnimScheduler::post(Command_t command, ECDEvalkitDisplay_t disp, EvalkitAnims::Anim_t anim)
+{
+    if (m_queue == nullptr)
+    {
+        ESP_LOGE(TAG, "Scheduler not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Event_t event = {
+        .command = command,
+        .disp    = disp,
+        .anim    = anim,
+    };
+    if (xQueueSend(m_queue, &event, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Event queue full, command %d dropped", (int)command);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+void AnimScheduler::apply(const Event_t& event)
+{
+    auto& anims = EvalkitAnims::getInstance();
+    if (event.command == COMMAND_SELECT)
+    {
+        (void)anims.select(event.disp, event.anim);
+        return;
+    }
+    if (!anims.isSelected())
+    {
+        return;
+    }
+
+    AnimBase& anim = anims.getCurrentAnim();
+    switch (event.command)
+    {
+        case COMMAND_START:
+            anim.start();
+            break;
+        case COMMAND_PAUSE:
+            anim.pause();
+            break;
+        case COMMAND_RESUME:
+            anim.resume();
+            break;
+        case COMMAND_ABORT:
+            anim.abort();
+            break;
+        case COMMAND_CHANGE_STATE:
+            (void)anim.changeState();
+            break;
+        default:
+            break;
+    }
+}
+
+void AnimScheduler::step(int64_t nowUs)
+{
+    auto& anims = EvalkitAnims::getInstance();
+    if (!anims.isSelected())
+    {
+        m_deadlineUs = AnimBase::NO_DEADLINE;
+        return;
+    }
+
+    AnimBase& anim = anims.getCurrentAnim();
+    m_deadlineUs   = anim.step(nowUs);
+    if (m_stepCallback != nullptr)
+    {
+        m_stepCallback(anim);
+    }
+}
+
+void AnimScheduler::taskEntry(void* arg)
+{
+    static_cast<AnimScheduler*>(arg)->run();
+}
+
+void AnimScheduler::run()
+{
+    while (true)
+    {
+        Event_t event;
+        if (xQueueReceive(m_queue, &event, ticksUntil(m_deadlineUs)) == pdTRUE)
+        {
+            // apply all pending events, then step once so the new state is shown right away
+            do
+            {
+                apply(event);
+            } while (xQueueReceive(m_queue, &event, 0) == pdTRUE);
+            m_deadlineUs = 0;
+        }
+
+        int64_t nowUs = esp_timer_get_time();
+        if (nowUs >= m_deadlineUs)
+        {
+            step(nowUs);
+        }
+    }
+}
+
+}  // namespace anim
+}  // namespace ynv
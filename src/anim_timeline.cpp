@@ -0,0 +1,119 @@
+/**
+ * @file anim_timeline.cpp
+ * @brief Data-driven animations: timelines of segment masks and hold times
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "anim_timeline.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+
+namespace ynv
+{
+namespace anim
+{
+
+namespace
+{
+/** @brief Size of the binary header: magic, version, flags, segments, reserved, count */
+constexpr size_t HEADER_SIZE = 12;
+
+/** @brief Size of a binary frame: mask, holdMs */
+constexpr size_t FRAME_SIZE = 8;
+
+uint32_t readU32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+}  // namespace
+
+Timeline& Timeline::operator=(const Timeline& other)
+{
+    if (this != &other)
+    {
+        m_storage  = other.m_storage;
+        m_frames   = other.m_storage.empty() ? other.m_frames : m_storage.data();
+        m_count    = other.m_count;
+        m_loop     = other.m_loop;
+        m_segments = other.m_segments;
+    }
+    return *this;
+}
+
+esp_err_t Timeline::load(const uint8_t* data, size_t size)
+{
+    if (data == nullptr || size < HEADER_SIZE)
+    {
+        ESP_LOGE(TAG, "Truncated header");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[4] != VERSION)
+    {
+        ESP_LOGE(TAG, "Unknown format or version %u", data[4]);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    uint32_t count = readU32(data + 8);
+    if (count == 0 || count > MAX_FRAMES)
+    {
+        ESP_LOGE(TAG, "Invalid frame count %" PRIu32, count);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size < HEADER_SIZE + (size_t)count * FRAME_SIZE)
+    {
+        ESP_LOGE(TAG, "Truncated frames (%u of %" PRIu32 ")", (unsigned)((size - HEADER_SIZE) / FRAME_SIZE), count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    std::vector<Frame_t> frames(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint8_t* p = data + HEADER_SIZE + i * FRAME_SIZE;
+        frames[i]        = {.mask = readU32(p), .holdMs = readU32(p + 4)};
+    }
+
+    m_storage  = std::move(frames);
+    m_frames   = m_storage.data();
+    m_count    = m_storage.size();
+    m_loop     = (data[5] & FLAG_LOOP) != 0;
+    m_segments = data[6];
+    return ESP_OK;
+}
+
+esp_err_t Timeline::load(const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // header first, so that only the frames it announces are buffered
+    std::vector<uint8_t> data(HEADER_SIZE);
+    size_t               size = std::fread(data.data(), 1, HEADER_SIZE, file);
+    if (size == HEADER_SIZE)
+    {
+        uint32_t count = std::min(readU32(data.data() + 8), MAX_FRAMES);
+        data.resize(HEADER_SIZE + (size_t)count * FRAME_SIZE);
+        size += std::fread(data.data() + HEADER_SIZE, 1, data.size() - HEADER_SIZE, file);
+    }
+    bool err = std::ferror(file) != 0;
+    std::fclose(file);
+    if (err)
+    {
+        ESP_LOGE(TAG, "Cannot read %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    return load(data.data(), size);
+}
+
+}  // namespace anim
+}  // namespace ynv
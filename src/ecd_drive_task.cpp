@@ -0,0 +1,149 @@
+/**
+ * @file ecd_drive_task.cpp
+ * @brief Background drive task for asynchronous ECD updates
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "ecd_drive_task.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ecd.hpp"
+#include "esp_log.h"
+
+namespace ynv
+{
+namespace ecd
+{
+
+esp_err_t ECDDriveTask::init(UBaseType_t priority, uint32_t stackSize)
+{
+    if (m_task != nullptr)
+    {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(taskEntry, "ecd-drive", stackSize, this, priority, &m_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create drive task");
+        m_task = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ECDDriveTask::submit(ECDBase* display, UpdateCallback_f cb, bool supersede)
+{
+    assert(display != nullptr);
+
+    if (m_task == nullptr)
+    {
+        ESP_LOGE(TAG, "Drive task not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bool      queued = true;
+    esp_err_t err    = ESP_OK;
+
+    taskENTER_CRITICAL(&m_lock);
+    size_t index = 0;
+    while (index < m_pendingCount && m_pending[index].display != display)
+    {
+        index++;
+    }
+
+    if (index < m_pendingCount)
+    {
+        // the pending job reads the latest target states when it starts, only the callback changes
+        m_pending[index].cb = cb;
+        if (supersede && m_running == display)
+        {
+            m_running->abortUpdate();
+        }
+    }
+    else if (m_running == display && !supersede)
+    {
+        // the running job already drives to the requested states, take over its completion
+        m_runningCb = cb;
+        queued      = false;
+    }
+    else if (m_pendingCount < MAX_PENDING)
+    {
+        if (m_running == display)
+        {
+            m_running->abortUpdate();
+        }
+        m_pending[m_pendingCount++] = {.display = display, .cb = cb};
+    }
+    else
+    {
+        err = ESP_ERR_NO_MEM;
+    }
+    taskEXIT_CRITICAL(&m_lock);
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Too many displays pending");
+        return err;
+    }
+    if (queued)
+    {
+        xTaskNotifyGive(m_task);
+    }
+    return ESP_OK;
+}
+
+bool ECDDriveTask::isBusy()
+{
+    taskENTER_CRITICAL(&m_lock);
+    bool busy = (m_running != nullptr) || (m_pendingCount > 0);
+    taskEXIT_CRITICAL(&m_lock);
+    return busy;
+}
+
+void ECDDriveTask::taskEntry(void* arg)
+{
+    auto* self = static_cast<ECDDriveTask*>(arg);
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->run();
+    }
+}
+
+void ECDDriveTask::run()
+{
+    while (true)
+    {
+        taskENTER_CRITICAL(&m_lock);
+        if (m_pendingCount == 0)
+        {
+            taskEXIT_CRITICAL(&m_lock);
+            return;
+        }
+        ECDBase* display = m_pending[0].display;
+        m_running        = display;
+        m_runningCb      = m_pending[0].cb;
+        std::copy(m_pending.begin() + 1, m_pending.begin() + m_pendingCount, m_pending.begin());
+        m_pendingCount--;
+        taskEXIT_CRITICAL(&m_lock);
+
+        bool completed = display->driveAsync();
+
+        taskENTER_CRITICAL(&m_lock);
+        UpdateCallback_f cb = m_runningCb;
+        m_running           = nullptr;
+        m_runningCb         = nullptr;
+        taskEXIT_CRITICAL(&m_lock);
+
+        if (completed && cb != nullptr)
+        {
+            cb(display);
+        }
+    }
+}
+
+}  // namespace ecd
+}  // namespace ynv
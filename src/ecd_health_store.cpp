@@ -0,0 +1,77 @@
+/**
+ * @file ecd_health_store.cpp
+ * @brief NVS storage of the segment health records
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "ecd_health_store.hpp"
+
+#include "esp_log.h"
+
+namespace ynv
+{
+namespace ecd
+{
+
+esp_err_t ECDHealthStore::open()
+{
+    if (m_open)
+    {
+        return ESP_OK;
+    }
+
+    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &m_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to open NVS namespace %s: %s", NAMESPACE, esp_err_to_name(err));
+        return err;
+    }
+    m_open = true;
+    return ESP_OK;
+}
+
+esp_err_t ECDHealthStore::load(const char* key, void* data, size_t size)
+{
+    esp_err_t err = open();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    size_t stored {0};
+    err = nvs_get_blob(m_handle, key, nullptr, &stored);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (stored != size)
+    {
+        ESP_LOGW(TAG, "Ignoring %s, size %u instead of %u", key, (unsigned)stored, (unsigned)size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return nvs_get_blob(m_handle, key, data, &stored);
+}
+
+esp_err_t ECDHealthStore::save(const char* key, const void* data, size_t size)
+{
+    esp_err_t err = open();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_blob(m_handle, key, data, size);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(m_handle);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to save %s: %s", key, esp_err_to_name(err));
+    }
+    return err;
+}
+
+}  // namespace ecd
+}  // namespace ynv
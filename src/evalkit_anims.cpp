@@ -25,6 +25,7 @@
 #include "anim_14.hpp"
 #include "anim_15.hpp"
 #include "anim_test.hpp"
+#include "ynv_event_bus.hpp"
 
 namespace ynv
 {
@@ -52,7 +53,10 @@ EvalkitAnims::Anim_t EvalkitAnims::select(ynv::ecd::EvalkitDisplays::ECDEvalkitD
     m_currentAnim = anim;
     if (m_anims[m_currentAnim] != nullptr)
     {
-        m_anims[m_currentAnim]->registerStateChangeCallback(m_stateChangeCallback);
+        m_anims[m_currentAnim]->setEventSource((uint8_t)m_dispIndex);  // events carry the display
+        m_anims[m_currentAnim]->setAsyncUpdate(m_asyncUpdate);
+        m_anims[m_currentAnim]->setTransitionRate(m_transitionRates[m_currentAnim]);
+        m_anims[m_currentAnim]->setRefreshInterval(m_refreshInterval);
         m_anims[m_currentAnim]->start();  // Start the newly selected animation
     }
     return m_currentAnim;
@@ -60,6 +64,12 @@ EvalkitAnims::Anim_t EvalkitAnims::select(ynv::ecd::EvalkitDisplays::ECDEvalkitD
 
 void EvalkitAnims::setDisplay(ynv::ecd::EvalkitDisplays::ECDEvalkitDisplay_t disp)
 {
+    if (isSelected())
+    {
+        // the animation of the previous display goes away without finishing, report it stopped
+        ynv::driver::EventBus::getInstance().publish(ynv::driver::EVENT_ANIM_STATE, (uint8_t)m_dispIndex,
+                                                     (int32_t)AnimBase::State_t::IDLE);
+    }
     m_anims = {};  // reset the list of animations
 
     auto& displays = ynv::ecd::EvalkitDisplays::getInstance();
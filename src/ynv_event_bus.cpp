@@ -0,0 +1,118 @@
+/**
+ * @file ynv_event_bus.cpp
+ * @brief Lock-free ring of animation and drive events for asynchronous subscribers
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "ynv_event_bus.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esp_timer.h"
+
+namespace ynv
+{
+namespace driver
+{
+
+void EventBus::publish(EventType_t type, uint8_t source, int32_t value)
+{
+    Event_t event = {
+        .timeUs   = (uint32_t)esp_timer_get_time(),
+        .type     = type,
+        .source   = source,
+        .reserved = 0,
+        .value    = value,
+    };
+    uint32_t words[EVENT_WORDS];
+    std::memcpy(words, &event, sizeof(event));
+
+    uint32_t ticket = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot_t&  slot   = m_slots[ticket % CAPACITY];
+
+    // odd sequence while the words are written, readers retry or skip the slot
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < EVENT_WORDS; ++i)
+    {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+
+    int count = std::min(m_notifyCount.load(std::memory_order_acquire), MAX_NOTIFY);
+    for (int i = 0; i < count; ++i)
+    {
+        TaskHandle_t task = m_notify[i].load(std::memory_order_acquire);
+        if (task != nullptr)
+        {
+            (void)xTaskNotifyGive(task);
+        }
+    }
+}
+
+esp_err_t EventBus::subscribe(Subscriber_t& sub, TaskHandle_t notify)
+{
+    if (notify != nullptr)
+    {
+        int index = m_notifyCount.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= MAX_NOTIFY)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        m_notify[index].store(notify, std::memory_order_release);
+    }
+
+    sub.cursor  = m_head.load(std::memory_order_acquire);
+    sub.dropped = 0;
+    return ESP_OK;
+}
+
+bool EventBus::poll(Subscriber_t& sub, Event_t& event)
+{
+    for (;;)
+    {
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        if (sub.cursor == head)
+        {
+            return false;
+        }
+        if (head - sub.cursor > CAPACITY)
+        {
+            // lapped, the oldest events are gone
+            sub.dropped += head - sub.cursor - CAPACITY;
+            sub.cursor = head - CAPACITY;
+        }
+
+        Slot_t&  slot     = m_slots[sub.cursor % CAPACITY];
+        uint32_t expected = 2 * sub.cursor + 2;
+        uint32_t seq      = slot.seq.load(std::memory_order_acquire);
+        if (seq != expected)
+        {
+            if ((int32_t)(seq - expected) < 0)
+            {
+                return false;  // claimed but not written yet, events stay in order
+            }
+            continue;  // rewritten by a later ticket, the head check skips it
+        }
+
+        uint32_t words[EVENT_WORDS];
+        for (size_t i = 0; i < EVENT_WORDS; ++i)
+        {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != expected)
+        {
+            continue;  // rewritten while copying
+        }
+
+        std::memcpy(&event, words, sizeof(event));
+        sub.cursor++;
+        return true;
+    }
+}
+
+}  // namespace driver
+}  // namespace ynv
@@ -0,0 +1,308 @@
+/**
+ * @file ynv_hal_batch.cpp
+ * @brief HAL proxy that merges the pulses and reads of several concurrently driven displays
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "ynv_hal_batch.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "esp_log.h"
+
+namespace ynv
+{
+namespace driver
+{
+
+BatchHAL::BatchHAL(HALBase* target)
+    : m_target(target),
+      m_requests(),
+      m_batch(),
+      m_pins(),
+      m_values(),
+      m_attached(0),
+      m_waiting(0),
+      m_combining(false),
+      m_lastHigh(false),
+      m_lastCommon(-1),
+      m_stats()
+{
+    assert(m_target != nullptr);
+}
+
+esp_err_t BatchHAL::init()
+{
+    for (auto& request : m_requests)
+    {
+        if (request.done == nullptr)
+        {
+            request.done = xSemaphoreCreateBinary();
+        }
+        if (request.done == nullptr)
+        {
+            ESP_LOGE(TAG, "Failed to create request semaphore");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+void BatchHAL::attach()
+{
+    taskENTER_CRITICAL(&m_lock);
+    m_attached++;
+    assert(m_attached <= MAX_CLIENTS);
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+void BatchHAL::detach()
+{
+    taskENTER_CRITICAL(&m_lock);
+    assert(m_attached > 0);
+    m_attached--;
+    taskEXIT_CRITICAL(&m_lock);
+
+    // the others may only have been waiting for this task
+    combine();
+}
+
+esp_err_t BatchHAL::digitalWrite(int pin, bool high, int delay, int common)
+{
+    Pulse_t p = {.pin = pin, .high = high, .durationUs = delay * 1000, .common = common};
+    return submit(&p, nullptr, nullptr, 1);
+}
+
+esp_err_t BatchHAL::digitalWriteMany(const int* pins, size_t count, bool high, int delay, int common)
+{
+    std::array<Pulse_t, MAX_REQUEST_SIZE> pulses;
+
+    esp_err_t ret = ESP_OK;
+    for (size_t first = 0; first < count; first += MAX_REQUEST_SIZE)
+    {
+        size_t n = std::min(count - first, MAX_REQUEST_SIZE);
+        for (size_t i = 0; i < n; ++i)
+        {
+            pulses[i] = {.pin = pins[first + i], .high = high, .durationUs = delay * 1000, .common = common};
+        }
+        esp_err_t err = submit(pulses.data(), nullptr, nullptr, n);
+        if (ret == ESP_OK)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+esp_err_t BatchHAL::pulse(const Pulse_t* pulses, size_t count)
+{
+    esp_err_t ret = ESP_OK;
+    for (size_t first = 0; first < count; first += MAX_REQUEST_SIZE)
+    {
+        esp_err_t err = submit(pulses + first, nullptr, nullptr, std::min(count - first, MAX_REQUEST_SIZE));
+        if (ret == ESP_OK)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+int BatchHAL::analogRead(int pin)
+{
+    int val = -1;
+    (void)analogReadMany(&pin, 1, &val);
+    return val;
+}
+
+esp_err_t BatchHAL::analogReadMany(const int* pins, size_t count, int* values)
+{
+    esp_err_t ret = ESP_OK;
+    for (size_t first = 0; first < count; first += MAX_REQUEST_SIZE)
+    {
+        esp_err_t err = submit(nullptr, pins + first, values + first, std::min(count - first, MAX_REQUEST_SIZE));
+        if (ret == ESP_OK)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+void BatchHAL::getStats(Stats_t& stats)
+{
+    taskENTER_CRITICAL(&m_lock);
+    stats = m_stats;
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+esp_err_t BatchHAL::submit(const Pulse_t* pulses, const int* pins, int* values, size_t count)
+{
+    assert(count <= MAX_REQUEST_SIZE);
+
+    taskENTER_CRITICAL(&m_lock);
+    Request_t* request = nullptr;
+    for (auto& r : m_requests)
+    {
+        if (!r.used)
+        {
+            request = &r;
+            break;
+        }
+    }
+    if (request != nullptr)
+    {
+        request->pulses = pulses;
+        request->pins   = pins;
+        request->values = values;
+        request->count  = count;
+        request->result = ESP_OK;
+        request->used   = true;
+        request->taken  = false;
+        m_waiting++;
+    }
+    taskEXIT_CRITICAL(&m_lock);
+
+    if (request == nullptr)
+    {
+        ESP_LOGE(TAG, "More than %d tasks in the HAL", MAX_CLIENTS);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // the last attached task to arrive runs the batch, the others sleep until it is done
+    combine();
+    (void)xSemaphoreTake(request->done, portMAX_DELAY);
+
+    taskENTER_CRITICAL(&m_lock);
+    esp_err_t result = request->result;
+    request->used    = false;
+    taskEXIT_CRITICAL(&m_lock);
+    return result;
+}
+
+void BatchHAL::combine()
+{
+    taskENTER_CRITICAL(&m_lock);
+    if (m_combining)
+    {
+        taskEXIT_CRITICAL(&m_lock);
+        return;  // the running step checks for the next one when it ends
+    }
+    m_combining = true;
+
+    // one step at a time, every attached task has its next request queued before a step is chosen
+    while (m_waiting > 0 && m_waiting >= m_attached)
+    {
+        int size = select();
+        m_waiting -= size;
+        taskEXIT_CRITICAL(&m_lock);
+
+        execute(size);
+
+        taskENTER_CRITICAL(&m_lock);
+    }
+
+    m_combining = false;
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+int BatchHAL::select()
+{
+    int size {0};
+    for (int i = 0; i < MAX_CLIENTS; ++i)
+    {
+        if (m_requests[i].used && !m_requests[i].taken && m_requests[i].pins != nullptr)
+        {
+            m_batch[size++] = i;
+        }
+    }
+
+    if (size == 0)
+    {
+        // shortest pulse request first, on a tie the one that continues the current level
+        int64_t best {0};
+        bool    bestJoins {false};
+        for (int i = 0; i < MAX_CLIENTS; ++i)
+        {
+            const Request_t& request = m_requests[i];
+            if (!request.used || request.taken)
+            {
+                continue;
+            }
+
+            int64_t durationUs {0};
+            for (size_t j = 0; j < request.count; ++j)
+            {
+                durationUs += request.pulses[j].durationUs;
+            }
+            bool joins = request.count > 0 && request.pulses[0].high == m_lastHigh &&
+                         request.pulses[0].common == m_lastCommon;
+            if (size == 0 || durationUs < best || (durationUs == best && joins && !bestJoins))
+            {
+                m_batch[0] = i;
+                size       = 1;
+                best       = durationUs;
+                bestJoins  = joins;
+            }
+        }
+    }
+
+    for (int k = 0; k < size; ++k)
+    {
+        m_requests[m_batch[k]].taken = true;
+    }
+    return size;
+}
+
+void BatchHAL::execute(int size)
+{
+    size_t pulseCount {0};
+    size_t pinCount {0};
+
+    if (m_requests[m_batch[0]].pins != nullptr)
+    {
+        // all reads in one scan
+        for (int k = 0; k < size; ++k)
+        {
+            const Request_t& request = m_requests[m_batch[k]];
+            std::copy(request.pins, request.pins + request.count, m_pins.begin() + pinCount);
+            pinCount += request.count;
+        }
+
+        esp_err_t err = m_target->analogReadMany(m_pins.data(), pinCount, m_values.data());
+        size_t    offset {0};
+        for (int k = 0; k < size; ++k)
+        {
+            Request_t& request = m_requests[m_batch[k]];
+            std::copy(m_values.begin() + offset, m_values.begin() + offset + request.count, request.values);
+            offset += request.count;
+            request.result = err;
+            (void)xSemaphoreGive(request.done);
+        }
+    }
+    else
+    {
+        // the pulses of a request stay together and in order, its caller continues right after them
+        Request_t& request = m_requests[m_batch[0]];
+        pulseCount         = request.count;
+        request.result     = m_target->pulse(request.pulses, request.count);
+        if (pulseCount > 0)
+        {
+            m_lastHigh   = request.pulses[pulseCount - 1].high;
+            m_lastCommon = request.pulses[pulseCount - 1].common;
+        }
+        (void)xSemaphoreGive(request.done);
+    }
+
+    taskENTER_CRITICAL(&m_lock);
+    m_stats.batches++;
+    m_stats.requests += size;
+    m_stats.pulses += pulseCount;
+    m_stats.reads += pinCount;
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+}  // namespace driver
+}  // namespace ynv
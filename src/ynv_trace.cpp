@@ -0,0 +1,109 @@
+/**
+ * @file ynv_trace.cpp
+ * @brief Compile-time gated binary trace of the HAL and driver hot path
+ * @date 2025-10-19
+ * @copyright Copyright (c) 2025
+ */
+
+#include "ynv_trace.hpp"
+
+#ifdef CONFIG_YNV_TRACE
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace ynv
+{
+namespace driver
+{
+
+void Trace::record(TraceEvent_t event, int pin, bool level, int32_t durationUs, int common, int value)
+{
+    TraceRecord_t r = {
+        .timeUs     = (uint32_t)esp_timer_get_time(),
+        .event      = event,
+        .pin        = (uint8_t)pin,
+        .level      = (uint8_t)level,
+        .reserved   = 0,
+        .durationUs = durationUs,
+        .common     = (uint16_t)common,
+        .value      = (uint16_t)value,
+    };
+
+    taskENTER_CRITICAL(&m_lock);
+    if (m_dumping)
+    {
+        m_dropped++;  // the buffer is being written to the log
+    }
+    else
+    {
+        m_records[m_head] = r;
+        m_head            = (m_head + 1) % CAPACITY;
+        if (m_count < CAPACITY)
+        {
+            m_count++;
+        }
+        else
+        {
+            m_dropped++;
+        }
+    }
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+size_t Trace::read(TraceRecord_t* out, size_t max)
+{
+    taskENTER_CRITICAL(&m_lock);
+    size_t count = std::min(m_count, max);
+    size_t first = (m_head + CAPACITY - m_count) % CAPACITY;
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = m_records[(first + i) % CAPACITY];
+    }
+    taskEXIT_CRITICAL(&m_lock);
+    return count;
+}
+
+void Trace::dump()
+{
+    // recording is paused while the log is written, records arriving meanwhile are counted as dropped
+    taskENTER_CRITICAL(&m_lock);
+    size_t   count   = m_count;
+    size_t   first   = (m_head + CAPACITY - m_count) % CAPACITY;
+    uint32_t dropped = m_dropped;
+    m_dumping        = true;
+    m_dropped        = 0;
+    taskEXIT_CRITICAL(&m_lock);
+
+    ESP_LOGI(TAG, "YNVTRACE BEGIN count=%u dropped=%" PRIu32, (unsigned)count, dropped);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* b = reinterpret_cast<const uint8_t*>(&m_records[(first + i) % CAPACITY]);
+        ESP_LOGI(TAG, "YNVTRACE %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", b[0], b[1], b[2],
+                 b[3], b[4], b[5], b[6], b[7], b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+    }
+    ESP_LOGI(TAG, "YNVTRACE END");
+
+    taskENTER_CRITICAL(&m_lock);
+    m_head    = 0;
+    m_count   = 0;
+    m_dumping = false;
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+void Trace::clear()
+{
+    taskENTER_CRITICAL(&m_lock);
+    m_head    = 0;
+    m_count   = 0;
+    m_dropped = 0;
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+}  // namespace driver
+}  // namespace ynv
+
+#endif  // CONFIG_YNV_TRACE
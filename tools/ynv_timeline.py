@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Compile a text timeline for AnimTimeline (include/anim_timeline.hpp).
+
+Every line of the source is a frame "<segments> <hold ms>" or a directive, "#" starts a comment:
+
+    segments 7          # segment count of the display (needed for "*" and the range check)
+    loop                # start over after the last frame (default), or "once"
+    0,1      200        # segments 0 and 1 colored for 200 ms
+    2-4      200        # segments 2, 3 and 4
+    0b101    300        # mask, bit i = segment i (also 0x..)
+    -        500        # all bleached
+    *        500        # all colored
+
+Consecutive frames with the same segments are merged. The report lists the segments each frame switches,
+the only ones the driver has to pulse. Output:
+
+    tools/ynv_timeline.py wave.txt                                # report
+    tools/ynv_timeline.py wave.txt --header main/wave.hpp         # constexpr frame array
+    tools/ynv_timeline.py wave.txt --bin spiffs/wave.ynvt         # binary for Timeline::load()
+
+The binary layout must match Timeline in include/anim_timeline.hpp.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# magic, version, flags, segments, reserved, count (little endian)
+HEADER = struct.Struct("<4sBBBBI")
+# Frame_t: mask, holdMs
+FRAME = struct.Struct("<II")
+
+MAGIC = b"YNVT"
+VERSION = 1
+FLAG_LOOP = 0x01
+MAX_SEGMENTS = 32
+MAX_FRAMES = 4096
+
+
+def parse_mask(text, segments):
+    """Segment mask of a frame state."""
+    if text == "-":
+        return 0
+    if text == "*":
+        if not segments:
+            raise ValueError('"*" needs a "segments" directive')
+        return (1 << segments) - 1
+    if text.startswith(("0x", "0b")):
+        return int(text, 0)
+    mask = 0
+    for part in text.split(","):
+        first, _, last = part.partition("-")
+        for i in range(int(first), int(last or first) + 1):
+            mask |= 1 << i
+    return mask
+
+
+def parse(lines):
+    """Return (segments, loop, frames) of a text timeline, frames as [mask, hold_ms]."""
+    segments = 0
+    loop = True
+    frames = []
+    for number, line in enumerate(lines, 1):
+        words = line.split("#", 1)[0].split()
+        try:
+            if not words:
+                continue
+            if words[0] == "segments" and len(words) == 2:
+                segments = int(words[1])
+                if not 0 < segments <= MAX_SEGMENTS:
+                    raise ValueError("segment count must be 1..%d" % MAX_SEGMENTS)
+            elif words == ["loop"] or words == ["once"]:
+                loop = words[0] == "loop"
+            elif len(words) == 2:
+                mask = parse_mask(words[0], segments)
+                hold_ms = int(words[1])
+                if hold_ms <= 0:
+                    raise ValueError("hold time must be positive")
+                limit = segments or MAX_SEGMENTS
+                if mask >> limit:
+                    raise ValueError("segment outside 0..%d" % (limit - 1))
+                frames.append([mask, hold_ms])
+            else:
+                raise ValueError("expected <segments> <hold ms> or a directive")
+        except ValueError as e:
+            sys.exit("line %d: %s" % (number, e))
+    if not frames:
+        sys.exit("no frames")
+    return segments, loop, frames
+
+
+def merge(frames):
+    """Merge consecutive frames with the same segments, their hold times add up."""
+    merged = []
+    for mask, hold_ms in frames:
+        if merged and merged[-1][0] == mask:
+            merged[-1][1] += hold_ms
+        else:
+            merged.append([mask, hold_ms])
+    return merged
+
+
+def changes(frames, loop):
+    """Segments switched by every frame: colored, bleached (the first frame starts from the last when looping)."""
+    previous = frames[-1][0] if loop else 0
+    result = []
+    for mask, _ in frames:
+        diff = mask ^ previous
+        result.append((diff & mask, diff & previous))
+        previous = mask
+    return result
+
+
+def bits(mask):
+    return ",".join(str(i) for i in range(MAX_SEGMENTS) if mask >> i & 1) or "-"
+
+
+def report(segments, loop, frames, switched, out):
+    width = segments or max(max(m.bit_length() for m, _ in frames), 1)
+    column = max(width, len("segments"))
+    out.write("%5s | %-*s | %8s | %-12s | %s\n" % ("frame", column, "segments", "hold_ms", "color", "bleach"))
+    for i, ((mask, hold_ms), (color, bleach)) in enumerate(zip(frames, switched)):
+        states = "".join("#" if mask >> s & 1 else "." for s in range(width))
+        out.write("%5d | %-*s | %8d | %-12s | %s\n" % (i, column, states, hold_ms, bits(color), bits(bleach)))
+    toggles = sum(bin(c | b).count("1") for c, b in switched)
+    out.write("%d frames, %d ms per %s, %d segment switches\n" %
+              (len(frames), sum(h for _, h in frames), "loop" if loop else "run", toggles))
+
+
+def write_header(path, name, source, loop, frames, switched):
+    symbol = re.sub(r"\W", "_", name).upper()
+    with open(path, "w") as f:
+        f.write("/**\n * @file %s\n * @brief Timeline %s, generated by tools/ynv_timeline.py from %s\n */\n" %
+                (os.path.basename(path), name, os.path.basename(source)))
+        f.write("#pragma once\n\n#include \"anim_timeline.hpp\"\n\n")
+        f.write("inline constexpr ynv::anim::Frame_t %s_FRAMES[] = {\n" % symbol)
+        for (mask, hold_ms), (color, bleach) in zip(frames, switched):
+            f.write("    {.mask = 0x%08x, .holdMs = %d},  // color %s, bleach %s\n" %
+                    (mask, hold_ms, bits(color), bits(bleach)))
+        f.write("};\n\ninline constexpr bool %s_LOOP = %s;\n" % (symbol, "true" if loop else "false"))
+
+
+def write_bin(path, segments, loop, frames):
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, FLAG_LOOP if loop else 0, segments, 0, len(frames)))
+        for mask, hold_ms in frames:
+            f.write(FRAME.pack(mask, hold_ms))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", type=argparse.FileType("r"), help="text timeline")
+    parser.add_argument("--header", help="write a C++ header with a constexpr frame array")
+    parser.add_argument("--name", help="name of the array in the header (default: source file name)")
+    parser.add_argument("--bin", help="write the binary format for Timeline::load()")
+    args = parser.parse_args()
+
+    segments, loop, frames = parse(args.source)
+    frames = merge(frames)
+    if len(frames) > MAX_FRAMES:
+        sys.exit("%d frames, at most %d" % (len(frames), MAX_FRAMES))
+    switched = changes(frames, loop)
+
+    report(segments, loop, frames, switched, sys.stderr if args.header or args.bin else sys.stdout)
+    if args.header:
+        name = args.name or os.path.splitext(os.path.basename(args.source.name))[0]
+        write_header(args.header, name, args.source.name, loop, frames, switched)
+    if args.bin:
+        write_bin(args.bin, segments, loop, frames)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Decode the binary trace of the YnVisible ECD driver (CONFIG_YNV_TRACE).
+
+YNV_TRACE_DUMP() writes the trace buffer to the log as hex lines between "YNVTRACE BEGIN" and
+"YNVTRACE END" markers. Capture the log (e.g. idf.py monitor | tee trace.log) and run:
+
+    tools/ynv_trace_decode.py trace.log
+    tools/ynv_trace_decode.py --csv trace.log > trace.csv
+
+The record layout must match TraceRecord_t in include/ynv_trace.hpp.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# TraceRecord_t: timeUs, event, pin, level, reserved, durationUs, common, value (little endian, 16 bytes)
+RECORD = struct.Struct("<IBBBBiHH")
+
+# TraceEvent_t
+EVENTS = {
+    1: "pulse",
+    2: "adc_read",
+    3: "refresh",
+    4: "anim_step",
+}
+
+BEGIN_RE = re.compile(r"YNVTRACE BEGIN count=(\d+) dropped=(\d+)")
+RECORD_RE = re.compile(r"YNVTRACE ([0-9a-f]{%d})" % (RECORD.size * 2))
+END_RE = re.compile(r"YNVTRACE END")
+
+
+def parse(lines):
+    """Yield (dump index, dropped, records) for every complete dump in the log."""
+    index = 0
+    records = None
+    dropped = 0
+    for line in lines:
+        m = BEGIN_RE.search(line)
+        if m:
+            records = []
+            dropped = int(m.group(2))
+            continue
+        if records is None:
+            continue
+        m = RECORD_RE.search(line)
+        if m:
+            records.append(RECORD.unpack(bytes.fromhex(m.group(1))))
+            continue
+        if END_RE.search(line):
+            yield index, dropped, records
+            index += 1
+            records = None
+
+
+def describe(event, pin, level, duration_us, common, value):
+    """Event specific columns: pin, level, duration, common, value."""
+    if event == 1:
+        return pin, "H" if level else "L", duration_us, common, ""
+    if event == 2:
+        return pin, "", "", "", value
+    if event == 3:
+        # value is the refresh attempt, durationUs the number of queued pulses
+        return "", "", "", "", "attempt=%d pulses=%d" % (value, duration_us)
+    return "", "", "", "", value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r", errors="replace"), default=sys.stdin,
+                        help="captured log (default: stdin)")
+    parser.add_argument("--csv", action="store_true", help="write CSV instead of a table")
+    args = parser.parse_args()
+
+    if args.csv:
+        print("dump,time_us,delta_us,event,pin,level,duration_us,common,value")
+    else:
+        print("%4s | %12s | %10s | %-9s | %3s | %5s | %11s | %6s | %s" %
+              ("dump", "time_us", "delta_us", "event", "pin", "level", "duration_us", "common", "value"))
+
+    for index, dropped, records in parse(args.log):
+        if dropped and not args.csv:
+            print("# dump %d: %d records lost (buffer full or recorded during a dump)" % (index, dropped))
+        last = None
+        for time_us, event, pin, level, _, duration_us, common, value in records:
+            # 32-bit timestamp, a wrap between two records shows as a small positive delta
+            delta = 0 if last is None else (time_us - last) & 0xFFFFFFFF
+            last = time_us
+            name = EVENTS.get(event, "event_%d" % event)
+            cols = describe(event, pin, level, duration_us, common, value)
+            if args.csv:
+                print(",".join(str(c) for c in (index, time_us, delta, name) + cols))
+            else:
+                print("%4d | %12d | %10d | %-9s | %3s | %5s | %11s | %6s | %s" %
+                      ((index, time_us, delta, name) + cols))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())